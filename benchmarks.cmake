@@ -0,0 +1,17 @@
+set(BENCHMARK_TARGET_PREFIX "irods_publishing_benchmark")
+
+foreach(BENCHMARK pep_dispatch catalog genquery_builder)
+    add_executable(
+        ${BENCHMARK_TARGET_PREFIX}-${BENCHMARK}
+        ${CMAKE_SOURCE_DIR}/benchmarks/${BENCHMARK}_benchmark.cpp
+        )
+
+    target_include_directories(
+        ${BENCHMARK_TARGET_PREFIX}-${BENCHMARK}
+        PRIVATE
+        ${CMAKE_SOURCE_DIR}
+        ${IRODS_EXTERNALS_FULLPATH_BOOST}/include
+        )
+
+    set_property(TARGET ${BENCHMARK_TARGET_PREFIX}-${BENCHMARK} PROPERTY CXX_STANDARD ${IRODS_CXX_STANDARD})
+endforeach()
@@ -0,0 +1,135 @@
+// Measures the catalog work the publishing plugin does on the open, create
+// and put peps, where every api call walks the ancestors of the target path
+// looking for the publish annotation, reporting queries and time per check.
+// A bulk put is measured both ways, checking each object of the bundle alone
+// and checking the bundle with its collections looked up once, and a create,
+// which can only be affected by the collections above the new object.
+
+#include "memory_catalog.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+    const std::string publish{"irods::publishing::publish"};
+
+    struct result {
+        double queries_per_check{};
+        double nanoseconds_per_check{};
+    };
+
+    using irods::publishing::path_check;
+
+    result measure(
+        irods::publishing::memory_catalog& _catalog,
+        const std::vector<std::string>&    _paths,
+        const int                          _iterations,
+        const path_check                   _check = path_check::object_and_ancestors) {
+        const auto queries = _catalog.query_count();
+        std::size_t published{};
+        const auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < _iterations; ++i) {
+            for(const auto& p : _paths) {
+                published += irods::publishing::attribute_exists_in_path(_catalog, p, publish, _check);
+            }
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // keep the calls observable
+        if(published == static_cast<std::size_t>(-1)) {
+            std::puts("");
+        }
+
+        const double checks = static_cast<double>(_iterations) * _paths.size();
+        return {
+            static_cast<double>(_catalog.query_count() - queries) / checks,
+            std::chrono::duration<double, std::nano>(elapsed).count() / checks};
+    }
+
+    result measure_bulk(
+        irods::publishing::memory_catalog& _catalog,
+        const std::vector<std::string>&    _paths,
+        const int                          _iterations) {
+        const auto queries = _catalog.query_count();
+        std::size_t published{};
+        const auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < _iterations; ++i) {
+            published += irods::publishing::object_with_attribute_in_paths(_catalog, _paths, publish).size();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // keep the calls observable
+        if(published == static_cast<std::size_t>(-1)) {
+            std::puts("");
+        }
+
+        const double checks = static_cast<double>(_iterations) * _paths.size();
+        return {
+            static_cast<double>(_catalog.query_count() - queries) / checks,
+            std::chrono::duration<double, std::nano>(elapsed).count() / checks};
+    }
+
+    std::string nested_collection(const std::string& _root, const int _depth) {
+        std::string coll{_root};
+        for(int d = 0; d < _depth; ++d) {
+            coll += "/level_" + std::to_string(d);
+        }
+        return coll;
+    }
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 20000;
+    const std::string home{"/tempZone/home/rods"};
+
+    irods::publishing::memory_catalog catalog;
+
+    std::printf("%-34s %12s %12s\n", "case", "queries", "ns");
+    for(const int depth : {1, 4, 16}) {
+        const auto published   = nested_collection(home + "/published", depth);
+        const auto unpublished = nested_collection(home + "/unpublished", depth);
+        catalog.add_collection_metadata(home + "/published", publish, "dataworld");
+
+        std::vector<std::string> published_objects;
+        std::vector<std::string> unpublished_objects;
+        for(int i = 0; i < 8; ++i) {
+            published_objects.push_back(published + "/file_" + std::to_string(i));
+            unpublished_objects.push_back(unpublished + "/file_" + std::to_string(i));
+            catalog.add_data_object(published_objects.back(), 1024);
+            catalog.add_data_object(unpublished_objects.back(), 1024);
+        }
+
+        const auto hit  = measure(catalog, published_objects, iterations);
+        const auto miss = measure(catalog, unpublished_objects, iterations);
+        const auto create = measure(catalog, unpublished_objects, iterations,
+                                    path_check::parent_only);
+        std::printf("%-34s %12.1f %12.1f\n",
+                    ("published ancestor, depth " + std::to_string(depth)).c_str(),
+                    hit.queries_per_check,
+                    hit.nanoseconds_per_check);
+        std::printf("%-34s %12.1f %12.1f\n",
+                    ("no published ancestor, depth " + std::to_string(depth)).c_str(),
+                    miss.queries_per_check,
+                    miss.nanoseconds_per_check);
+        std::printf("%-34s %12.1f %12.1f\n",
+                    ("create, parent only, depth " + std::to_string(depth)).c_str(),
+                    create.queries_per_check,
+                    create.nanoseconds_per_check);
+    }
+
+    // a bundle of objects ingested into a single unpublished collection
+    const auto bundle_collection = nested_collection(home + "/bulk", 4);
+    std::vector<std::string> bundle;
+    for(int i = 0; i < 64; ++i) {
+        bundle.push_back(bundle_collection + "/file_" + std::to_string(i));
+    }
+
+    const auto each    = measure(catalog, bundle, iterations / 64 + 1);
+    const auto batched = measure_bulk(catalog, bundle, iterations / 64 + 1);
+    std::printf("%-34s %12.2f %12.1f\n", "bulk put of 64, per object", each.queries_per_check, each.nanoseconds_per_check);
+    std::printf("%-34s %12.2f %12.1f\n", "bulk put of 64, per collection", batched.queries_per_check, batched.nanoseconds_per_check);
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+// Measures the cost of constructing the catalog queries issued on the pep
+// hot path, comparing the previous boost::format built query strings with
+// binding values into a pre-built genquery_template.  The string form is
+// additionally parsed into the general query input by irods::query on the
+// server, which this benchmark does not include.
+
+#include "genquery_builder.hpp"
+
+#include <boost/format.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+    // stand ins for the rodsGenQuery.h column numbers
+    enum {
+        COL_COLL_NAME            = 501,
+        COL_DATA_NAME            = 403,
+        COL_META_DATA_ATTR_NAME  = 600,
+        COL_META_DATA_ATTR_VALUE = 601,
+        COL_META_DATA_ATTR_UNITS = 602,
+        COL_META_COLL_ATTR_NAME  = 610,
+        COL_META_COLL_ATTR_VALUE = 611,
+        COL_META_COLL_ATTR_UNITS = 612
+    };
+
+    const irods::publishing::genquery_template object_metadata_query{
+        {{COL_META_DATA_ATTR_VALUE}, {COL_META_DATA_ATTR_UNITS}},
+        {{COL_META_DATA_ATTR_NAME, "= '?'"},
+         {COL_COLL_NAME,           "= '?'"},
+         {COL_DATA_NAME,           "= '?'"}}};
+
+    const irods::publishing::genquery_template collection_metadata_query{
+        {{COL_META_COLL_ATTR_VALUE}, {COL_META_COLL_ATTR_UNITS}},
+        {{COL_META_COLL_ATTR_NAME, "= '?'"},
+         {COL_COLL_NAME,           "= '?'"}}};
+
+    template<typename F>
+    double nanoseconds_per_call(F _f, const int _iterations) {
+        std::size_t size{};
+        const auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < _iterations; ++i) {
+            size += _f();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // keep the calls observable
+        if(size == static_cast<std::size_t>(-1)) {
+            std::puts("");
+        }
+
+        return std::chrono::duration<double, std::nano>(elapsed).count() / _iterations;
+    }
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 200000;
+
+    const std::string attribute{"irods::publishing::publish"};
+    const std::string coll_name{"/tempZone/home/rods/project/level_0/level_1"};
+    const std::string data_name{"file_0.dat"};
+
+    auto format_object = [&] {
+        return boost::str(boost::format(
+            "SELECT META_DATA_ATTR_VALUE, META_DATA_ATTR_UNITS WHERE META_DATA_ATTR_NAME = '%s' and COLL_NAME = '%s' and DATA_NAME = '%s'")
+            % attribute
+            % coll_name
+            % data_name).size();
+    };
+
+    auto bind_object = [&] {
+        return object_metadata_query.bind(attribute, coll_name, data_name).conditions.size();
+    };
+
+    auto format_collection = [&] {
+        return boost::str(boost::format(
+            "SELECT META_COLL_ATTR_VALUE, META_COLL_ATTR_UNITS WHERE META_COLL_ATTR_NAME = '%s' and COLL_NAME = '%s'")
+            % attribute
+            % coll_name).size();
+    };
+
+    auto bind_collection = [&] {
+        return collection_metadata_query.bind(attribute, coll_name).conditions.size();
+    };
+
+    std::printf("%-28s %14s %14s\n", "query", "format ns", "template ns");
+    std::printf("%-28s %14.1f %14.1f\n", "object metadata",
+                nanoseconds_per_call(format_object, iterations),
+                nanoseconds_per_call(bind_object, iterations));
+    std::printf("%-28s %14.1f %14.1f\n", "collection metadata",
+                nanoseconds_per_call(format_collection, iterations),
+                nanoseconds_per_call(bind_collection, iterations));
+
+    return 0;
+}
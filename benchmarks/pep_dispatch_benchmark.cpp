@@ -0,0 +1,105 @@
+// Measures the overhead the publishing plugin adds to every api invocation
+// on the server, which calls rule_exists for each pep of each api, by
+// comparing the previous per call std::set with the static dispatch table.
+
+#include "pep_dispatch_table.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+    using handler = int (*)();
+
+    int handled() { return 1; }
+
+    constexpr irods::publishing::static_dispatch_table<handler, 13> peps{{{
+        {"pep_api_data_obj_open_pre",     handled},
+        {"pep_api_data_obj_create_pre",   handled},
+        {"pep_api_data_obj_put_pre",      handled},
+        {"pep_api_data_obj_unlink_pre",   handled},
+        {"pep_api_rm_coll_pre",           handled},
+        {"pep_api_replica_open_pre",      handled},
+        {"pep_api_bulk_data_obj_put_pre", handled},
+        {"pep_api_data_obj_rename_pre",   handled},
+        {"pep_api_data_obj_copy_pre",     handled},
+        {"pep_api_data_obj_repl_pre",     handled},
+        {"pep_api_phy_path_reg_pre",      handled},
+        {"pep_api_mod_avu_metadata_pre",  handled},
+        {"pep_api_mod_avu_metadata_post", handled}}}};
+
+    bool set_rule_exists(const std::string& _rn) {
+        const std::set<std::string> rules{
+                                        "pep_api_rm_coll_pre",
+                                        "pep_api_data_obj_open_pre",
+                                        "pep_api_data_obj_create_pre",
+                                        "pep_api_data_obj_put_pre",
+                                        "pep_api_data_obj_unlink_pre",
+                                        "pep_api_replica_open_pre",
+                                        "pep_api_bulk_data_obj_put_pre",
+                                        "pep_api_data_obj_rename_pre",
+                                        "pep_api_data_obj_copy_pre",
+                                        "pep_api_data_obj_repl_pre",
+                                        "pep_api_phy_path_reg_pre",
+                                        "pep_api_mod_avu_metadata_pre",
+                                        "pep_api_mod_avu_metadata_post"};
+        return rules.find(_rn) != rules.end();
+    }
+
+    bool table_rule_exists(const std::string& _rn) {
+        return nullptr != peps.find(_rn);
+    }
+
+    template<typename F>
+    double nanoseconds_per_call(
+        F                               _f,
+        const std::vector<std::string>& _names,
+        const int                       _iterations) {
+        std::size_t hits{};
+        const auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < _iterations; ++i) {
+            for(const auto& n : _names) {
+                hits += _f(n);
+            }
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // keep the calls observable
+        if(hits == static_cast<std::size_t>(-1)) {
+            std::puts("");
+        }
+
+        return std::chrono::duration<double, std::nano>(elapsed).count() /
+               (static_cast<double>(_iterations) * _names.size());
+    }
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 200000;
+
+    // unrelated traffic is by far the common case
+    const std::vector<std::string> unrelated{
+        "pep_api_obj_stat_pre",
+        "pep_api_obj_stat_post",
+        "pep_api_auth_request_pre",
+        "pep_api_gen_query_pre",
+        "pep_api_gen_query_post",
+        "pep_api_data_obj_read_pre",
+        "pep_api_data_obj_close_post"};
+
+    const std::vector<std::string> related{
+        "pep_api_data_obj_open_pre",
+        "pep_api_mod_avu_metadata_post"};
+
+    std::printf("%-28s %12s %12s\n", "traffic", "std::set ns", "table ns");
+    std::printf("%-28s %12.1f %12.1f\n", "unrelated peps",
+                nanoseconds_per_call(set_rule_exists, unrelated, iterations),
+                nanoseconds_per_call(table_rule_exists, unrelated, iterations));
+    std::printf("%-28s %12.1f %12.1f\n", "publishing peps",
+                nanoseconds_per_call(set_rule_exists, related, iterations),
+                nanoseconds_per_call(table_rule_exists, related, iterations));
+
+    return 0;
+}
@@ -0,0 +1,227 @@
+#ifndef CATALOG_HPP
+#define CATALOG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace irods {
+    namespace publishing {
+        struct job_size_estimate {
+            uintmax_t bytes{};
+            uintmax_t objects{};
+        }; // struct job_size_estimate
+
+        struct delayed_rule {
+            std::string id;
+            std::string name;      // the rule text
+            std::string exec_time; // seconds since the epoch
+        }; // struct delayed_rule
+
+        // the catalog lookups made by the publishing framework.  the server
+        // implementation is genquery_catalog, memory_catalog holds the same
+        // information in process so the framework logic may be exercised and
+        // measured without a server
+        class catalog {
+        public:
+            // attribute value and units
+            using metadata_results = std::vector<std::pair<std::string, std::string>>;
+
+            virtual ~catalog() = default;
+
+            virtual metadata_results object_metadata(
+                const std::string& _object_path,
+                const std::string& _attribute) = 0;
+
+            virtual metadata_results collection_metadata(
+                const std::string& _collection_name,
+                const std::string& _attribute) = 0;
+
+            virtual std::vector<std::string> user_metadata(
+                const std::string& _user_name,
+                const std::string& _attribute) = 0;
+
+            // logical paths of the objects in the collection carrying _attribute
+            virtual std::vector<std::string> objects_with_metadata(
+                const std::string& _collection_name,
+                const std::string& _attribute) = 0;
+
+            // logical paths of every collection and object carrying _attribute
+            virtual std::vector<std::string> paths_with_metadata(
+                const std::string& _attribute) = 0;
+
+            virtual bool is_data_object(
+                const std::string& _path) = 0;
+
+            virtual uintmax_t data_object_size(
+                const std::string& _object_path) = 0;
+
+            // every replica of every object beneath the collection
+            virtual job_size_estimate collection_size(
+                const std::string& _collection_name) = 0;
+
+            // logical paths of the objects in the collection, or beneath it
+            virtual std::vector<std::string> list_data_objects(
+                const std::string& _collection_name,
+                const bool         _recursive) = 0;
+
+            // delayed rules whose name contains _name_fragment
+            virtual uintmax_t count_delayed_rules(
+                const std::string& _name_fragment) = 0;
+
+            // at most _limit delayed rules whose name contains _name_fragment,
+            // the soonest to execute first
+            virtual std::vector<delayed_rule> list_delayed_rules(
+                const std::string& _name_fragment,
+                const std::size_t  _limit) = 0;
+
+            // number of catalog queries issued through this instance
+            std::size_t query_count() const { return query_count_; }
+
+            // number of catalog queries issued by the calling thread through any instance
+            static std::size_t thread_query_count() { return thread_queries(); }
+
+        protected:
+            void count_query() {
+                ++query_count_;
+                ++thread_queries();
+            }
+
+        private:
+            static std::size_t& thread_queries() {
+                thread_local std::size_t queries{};
+                return queries;
+            }
+
+            std::size_t query_count_{};
+        }; // class catalog
+
+        // how much of a path must be looked up to learn whether an operation
+        // upon it would modify something published
+        enum class path_check {
+            none,                 // the operation cannot modify the path
+            parent_only,          // the path cannot exist yet, only the collections above it matter
+            object_and_ancestors  // the path itself and every collection above it
+        }; // enum class path_check
+
+        // parent of a logical path, empty for the root
+        inline std::string parent_collection(const std::string& _path) {
+            const auto pos = _path.find_last_of('/');
+            if(std::string::npos == pos || 0 == pos) {
+                return {};
+            }
+
+            return _path.substr(0, pos);
+        } // parent_collection
+
+        // true if any collection above _path carries _attribute
+        inline bool attribute_exists_above_path(
+            catalog&           _catalog,
+            const std::string& _path,
+            const std::string& _attribute) {
+            for(auto coll = parent_collection(_path); !coll.empty(); coll = parent_collection(coll)) {
+                if(!_catalog.collection_metadata(coll, _attribute).empty()) {
+                    return true;
+                }
+            }
+
+            return false;
+        } // attribute_exists_above_path
+
+        // true if the object or collection at _path, or any collection above
+        // it, carries _attribute
+        inline bool attribute_exists_in_path(
+            catalog&           _catalog,
+            const std::string& _path,
+            const std::string& _attribute) {
+            if(_catalog.is_data_object(_path)) {
+                if(!_catalog.object_metadata(_path, _attribute).empty()) {
+                    return true;
+                }
+            }
+            else if(!_catalog.collection_metadata(_path, _attribute).empty()) {
+                return true;
+            }
+
+            return attribute_exists_above_path(_catalog, _path, _attribute);
+        } // attribute_exists_in_path
+
+        // attribute_exists_in_path limited to what _check requires
+        inline bool attribute_exists_in_path(
+            catalog&           _catalog,
+            const std::string& _path,
+            const std::string& _attribute,
+            const path_check   _check) {
+            switch(_check) {
+                case path_check::none:                 return false;
+                case path_check::parent_only:          return attribute_exists_above_path(_catalog, _path, _attribute);
+                case path_check::object_and_ancestors: return attribute_exists_in_path(_catalog, _path, _attribute);
+            }
+            return true;
+        } // attribute_exists_in_path
+
+        // the first of the data objects at _object_paths which carries
+        // _attribute, or lies beneath a collection carrying it, empty when none
+        // do.  the objects are grouped by collection, which is queried once for
+        // its annotated objects however many of the paths it holds, and each
+        // collection above them is looked up only once.  objects which cannot
+        // exist yet are checked parent_only, skipping the collection listing
+        inline std::string object_with_attribute_in_paths(
+            catalog&                        _catalog,
+            const std::vector<std::string>& _object_paths,
+            const std::string&              _attribute,
+            const path_check                _check = path_check::object_and_ancestors) {
+            if(path_check::none == _check) {
+                return {};
+            }
+
+            std::map<std::string, std::vector<const std::string*>> objects_by_collection;
+            for(const auto& p : _object_paths) {
+                objects_by_collection[parent_collection(p)].push_back(&p);
+            }
+
+            std::map<std::string, bool> annotated;
+            const auto collection_is_annotated = [&](const std::string& _collection_name) {
+                auto it = annotated.find(_collection_name);
+                if(annotated.end() == it) {
+                    it = annotated.emplace(
+                             _collection_name,
+                             !_catalog.collection_metadata(_collection_name, _attribute).empty()).first;
+                }
+                return it->second;
+            };
+
+            for(const auto& c : objects_by_collection) {
+                for(auto coll = c.first; !coll.empty(); coll = parent_collection(coll)) {
+                    if(collection_is_annotated(coll)) {
+                        return *c.second.front();
+                    }
+                }
+
+                if(path_check::parent_only == _check) {
+                    continue;
+                }
+
+                const auto listed = _catalog.objects_with_metadata(c.first, _attribute);
+                if(listed.empty()) {
+                    continue;
+                }
+
+                const std::set<std::string> objects(listed.begin(), listed.end());
+                for(const auto* p : c.second) {
+                    if(objects.count(*p)) {
+                        return *p;
+                    }
+                }
+            }
+
+            return {};
+        } // object_with_attribute_in_paths
+    } // namespace publishing
+} // namespace irods
+
+#endif // CATALOG_HPP
@@ -20,9 +20,32 @@ namespace irods {
 
                 capture_parameter("publish", publish);
                 capture_parameter("api_token", api_token);
+                capture_parameter("fingerprint", fingerprint);
+                capture_parameter("job_metrics", job_metrics);
                 capture_parameter("minimum_delay_time", minimum_delay_time);
                 capture_parameter("maximum_delay_time", maximum_delay_time);
                 capture_parameter("delay_parameters",   delay_parameters);
+                capture_parameter("queue_sample_interval", queue_sample_interval);
+                capture_parameter("small_job_maximum_bytes", small_job_maximum_bytes);
+                capture_parameter("small_job_maximum_objects", small_job_maximum_objects);
+                capture_parameter("small_job_minimum_delay_time", small_job_minimum_delay_time);
+                capture_parameter("small_job_maximum_delay_time", small_job_maximum_delay_time);
+                capture_parameter("small_job_priority", small_job_priority);
+                capture_parameter("bulk_job_priority", bulk_job_priority);
+                capture_parameter("bulk_job_maximum_concurrency", bulk_job_maximum_concurrency);
+                capture_parameter("metrics_file", metrics_file);
+                capture_parameter("metrics_export_interval", metrics_export_interval);
+                capture_parameter("published_filter_refresh_interval", published_filter_refresh_interval);
+                capture_parameter("record_results", record_results);
+                capture_parameter("result_prefix", result_prefix);
+                capture_parameter("result_batch_size", result_batch_size);
+
+                if(const auto iter = cfg.find("preferred_resources"); iter != cfg.end()) {
+                    replica_selection.preferred_resources = iter->get<std::vector<std::string>>();
+                }
+                if(const auto iter = cfg.find("archive_resource_types"); iter != cfg.end()) {
+                    replica_selection.archive_types = iter->get<std::vector<std::string>>();
+                }
             } catch ( const exception& _e ) {
                 THROW( KEY_NOT_FOUND, fmt::format("[{}:{}] - [{}] [error_code=[{}], instance_name=[{}]",
                                       __func__, __LINE__, _e.client_display_what(), _e.code(), _instance_name));
@@ -71,6 +94,11 @@ namespace irods {
                     return policy::collection::purge;
                 } // else
             }
+            else if(operation_type::reconcile == _operation_type) {
+                if(publish_type::collection == _publish_type) {
+                    return policy::collection::reconcile;
+                } // else
+            }
 
             THROW(
                 SYS_INVALID_INPUT_PARAM,
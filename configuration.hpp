@@ -4,6 +4,8 @@
 #include <string>
 #include <irods/rodsLog.h>
 
+#include "replica_utilities.hpp"
+
 namespace irods {
     namespace publishing {
         const std::string metadata_separator{"::"};
@@ -28,8 +30,11 @@ namespace irods {
             namespace collection {
                 static const std::string publish{"irods_policy_publishing_collection_publish"};
                 static const std::string purge{"irods_policy_publishing_collection_purge"};
+                static const std::string reconcile{"irods_policy_publishing_collection_reconcile"};
             } // collection
 
+            static const std::string status{"irods_policy_publishing_status"};
+            static const std::string cancel{"irods_policy_publishing_cancel"};
         } // policy
 
         std::string operation_and_publish_types_to_policy_name(
@@ -46,22 +51,58 @@ namespace irods {
             static const std::string object{"object"};
         }
 
+        namespace lane {
+            static const std::string small{"small"};
+            static const std::string bulk{"bulk"};
+        }
+
         namespace operation_type {
             static const std::string publish{"publish"};
             static const std::string purge{"purge"};
+            static const std::string reconcile{"reconcile"};
         }
 
         struct configuration {
             // metadata attributes
             std::string publish{"irods::publishing::publish"};
             std::string api_token{"irods::publishing::api_token"};
+            std::string fingerprint{"irods::publishing::fingerprint"};
+            std::string job_metrics{"irods::publishing::job_metrics"};
 
             // basic configuration
             std::string minimum_delay_time{"1"};
             std::string maximum_delay_time{"30"};
             std::string delay_parameters{"<EF>60s DOUBLE UNTIL SUCCESS OR 5 TIMES</EF>"};
+            std::string queue_sample_interval{"10"};
             int log_level{LOG_DEBUG};
 
+            // job size estimation and priority lanes
+            std::string small_job_maximum_bytes{"104857600"};
+            std::string small_job_maximum_objects{"32"};
+            std::string small_job_minimum_delay_time{"0"};
+            std::string small_job_maximum_delay_time{"1"};
+            std::string small_job_priority{"1"};
+            std::string bulk_job_priority{"7"};
+            std::string bulk_job_maximum_concurrency{"2"};
+
+            // instrumentation, an empty metrics_file disables the export
+            std::string metrics_file{""};
+            std::string metrics_export_interval{"10"};
+
+            // filter of published paths answering most immutability checks
+            // without a query, rebuilt from the catalog at this interval in
+            // seconds.  zero disables the filter
+            std::string published_filter_refresh_interval{"0"};
+
+            // outcome of each publication recorded on the published paths,
+            // written in batches of result_batch_size paths
+            std::string record_results{"false"};
+            std::string result_prefix{"irods::publishing::result::"};
+            std::string result_batch_size{"1000"};
+
+            // replica selection for publish reads
+            replica_preferences replica_selection{};
+
             const std::string instance_name_{};
             explicit configuration(const std::string& _instance_name);
         }; // struct configuration
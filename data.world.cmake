@@ -8,6 +8,8 @@ set(TARGET_NAME "${IRODS_TARGET_NAME_PREFIX}-${POLICY_NAME}")
 
 include(IrodsExternals)
 
+find_package(CURL REQUIRED)
+
 IRODS_MACRO_CHECK_DEPENDENCY_SET_FULLPATH_ADD_TO_IRODS_PACKAGE_DEPENDENCIES_LIST(ELASTICCLIENT elasticlientd68e30e3-0)
 IRODS_MACRO_CHECK_DEPENDENCY_SET_FULLPATH_ADD_TO_IRODS_PACKAGE_DEPENDENCIES_LIST(CPR cpr1.3.0-1)
 
@@ -32,6 +34,13 @@ add_library(
     ${CMAKE_SOURCE_DIR}/utilities.cpp
     ${CMAKE_SOURCE_DIR}/configuration.cpp
     ${CMAKE_SOURCE_DIR}/plugin_specific_configuration.cpp
+    ${CMAKE_SOURCE_DIR}/publishing_backend.cpp
+    ${CMAKE_SOURCE_DIR}/fingerprint.cpp
+    ${CMAKE_SOURCE_DIR}/genquery_catalog.cpp
+    ${CMAKE_SOURCE_DIR}/replica_utilities.cpp
+    ${CMAKE_SOURCE_DIR}/pid_pool.cpp
+    ${CMAKE_SOURCE_DIR}/metadata_operations.cpp
+    ${CMAKE_SOURCE_DIR}/publication_results.cpp
     )
 
 target_include_directories(
@@ -55,8 +64,10 @@ target_link_libraries(
     ${IRODS_EXTERNALS_FULLPATH_ELASTICCLIENT}/lib/libelasticlient.so
     ${IRODS_EXTERNALS_FULLPATH_ELASTICCLIENT}/lib/libjsoncpp.so
     ${IRODS_EXTERNALS_FULLPATH_CPR}/lib/libcpr.so
+    CURL::libcurl
     irods_common
     nlohmann_json::nlohmann_json
+    ${CMAKE_DL_LIBS}
     )
 
 target_compile_definitions(${TARGET_NAME} PRIVATE ${IRODS_PLUGIN_POLICY_COMPILE_DEFINITIONS} ${IRODS_COMPILE_DEFINITIONS} ${IRODS_COMPILE_DEFINITIONS_PRIVATE} BOOST_SYSTEM_NO_DEPRECATED)
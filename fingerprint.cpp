@@ -0,0 +1,435 @@
+#include "fingerprint.hpp"
+#include "genquery_builder.hpp"
+
+#include <irods/irods_query.hpp>
+#include <irods/irods_hasher_factory.hpp>
+#include <irods/SHA256Strategy.hpp>
+#include <irods/rsModAVUMetadata.hpp>
+#include <irods/rodsLog.h>
+
+#include <boost/format.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <ctime>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace {
+    std::string digest(std::vector<std::string> _parts) {
+        std::sort(_parts.begin(), _parts.end());
+
+        irods::Hasher hasher;
+        irods::error err = irods::getHasher(irods::SHA256_NAME, hasher);
+        if(!err.ok()) {
+            THROW(err.code(), err.result());
+        }
+
+        for(const auto& p : _parts) {
+            hasher.update(p);
+            hasher.update("\n");
+        }
+
+        std::string d;
+        hasher.digest(d);
+        return d;
+    } // digest
+
+    std::string parent_of(const std::string& _collection) {
+        const auto pos = _collection.find_last_of('/');
+        return 0 == pos || std::string::npos == pos ? "/" : _collection.substr(0, pos);
+    } // parent_of
+
+    std::size_t depth_of(const std::string& _collection) {
+        return std::count(_collection.begin(), _collection.end(), '/');
+    } // depth_of
+
+    // deepest collections first so children are hashed before their parents
+    std::vector<std::string> bottom_up(const std::set<std::string>& _collections) {
+        std::vector<std::string> ordered{_collections.begin(), _collections.end()};
+        std::stable_sort(
+            ordered.begin(),
+            ordered.end(),
+            [](const std::string& _l, const std::string& _r) {
+                return depth_of(_l) > depth_of(_r);
+            });
+        return ordered;
+    } // bottom_up
+
+    // a replica without a checksum falls back to its size and modify time
+    std::string object_leaf(
+        const std::string& _name,
+        const std::string& _checksum,
+        const std::string& _size,
+        const std::string& _modify_time) {
+        return "d:" + _name + ":" + (_checksum.empty() ? _size + ":" + _modify_time : _checksum);
+    } // object_leaf
+
+    std::string node_hash(
+        const std::string&                  _objects_hash,
+        const std::map<std::string, std::string>& _children) {
+        std::vector<std::string> parts{"o:" + _objects_hash};
+        for(const auto& c : _children) {
+            parts.push_back("c:" + c.first + ":" + c.second);
+        }
+        return digest(std::move(parts));
+    } // node_hash
+
+    std::string names_digest(const std::set<std::string>& _names) {
+        return digest({_names.begin(), _names.end()});
+    } // names_digest
+
+    std::size_t count_of(
+        const std::map<std::string, std::size_t>& _counts,
+        const std::string&                         _collection) {
+        const auto itr = _counts.find(_collection);
+        return itr == _counts.end() ? 0 : itr->second;
+    } // count_of
+} // namespace
+
+namespace irods {
+    namespace publishing {
+        collection_fingerprint::collection_fingerprint(
+            rsComm_t*          _comm,
+            const std::string& _attribute) :
+              comm_{_comm}
+            , attribute_{_attribute} {
+        } // ctor
+
+        fingerprint_update collection_fingerprint::update(
+            const std::string& _root) {
+            // taken before the scans, a change made while they run is seen
+            // again by the next update
+            now_ = fmt::format("{:011d}", std::time(nullptr));
+            pending_.clear();
+
+            node root_node;
+            if(!read_node(_root, root_node)) {
+                return rebuild(_root);
+            }
+
+            return refresh(_root, root_node);
+        } // update
+
+        void collection_fingerprint::commit() {
+            for(const auto& p : pending_) {
+                write_node(p.first, p.second);
+            }
+            pending_.clear();
+        } // commit
+
+        void collection_fingerprint::invalidate(
+            const std::string& _root) {
+            pending_.clear();
+
+            modAVUMetadataInp_t inp{};
+            inp.arg0 = "rmw";
+            inp.arg1 = "-C";
+            inp.arg2 = const_cast<char*>(_root.c_str());
+            inp.arg3 = const_cast<char*>(attribute_.c_str());
+            inp.arg4 = "%";
+            inp.arg5 = "";
+            const auto status = rsModAVUMetadata(comm_, &inp);
+            if(status < 0) {
+                rodsLog(
+                    LOG_ERROR,
+                    "failed to invalidate fingerprint of [%s] [%d]",
+                    _root.c_str(),
+                    status);
+            }
+        } // invalidate
+
+        bool collection_fingerprint::parse_node(
+            const std::string& _value,
+            const std::string& _units,
+            node&              _node) {
+            // a node written in an older layout is treated as missing
+            std::istringstream units{_units};
+            node n;
+            units >> n.computed_at >> n.objects >> n.collections >> n.objects_hash >> n.names_hash;
+            if(units.fail()) {
+                return false;
+            }
+
+            n.hash = _value;
+            _node  = std::move(n);
+            return true;
+        } // parse_node
+
+        bool collection_fingerprint::read_node(
+            const std::string& _collection,
+            node&              _node) {
+            std::string query_str {
+                boost::str(boost::format(
+                "SELECT META_COLL_ATTR_VALUE, META_COLL_ATTR_UNITS WHERE META_COLL_ATTR_NAME = '%s' and COLL_NAME = '%s'")
+                % escape_genquery_literal(attribute_)
+                % escape_genquery_literal(_collection)) };
+            query<rsComm_t> qobj{comm_, query_str, 1};
+            if(qobj.size() == 0) {
+                return false;
+            }
+
+            const auto row = qobj.front();
+            return parse_node(row[0], row[1], _node);
+        } // read_node
+
+        void collection_fingerprint::write_node(
+            const std::string& _collection,
+            const node&        _node) {
+            const auto units = fmt::format(
+                                   "{} {} {} {} {}",
+                                   _node.computed_at,
+                                   _node.objects,
+                                   _node.collections,
+                                   _node.objects_hash,
+                                   _node.names_hash);
+            modAVUMetadataInp_t inp{};
+            inp.arg0 = "set";
+            inp.arg1 = "-C";
+            inp.arg2 = const_cast<char*>(_collection.c_str());
+            inp.arg3 = const_cast<char*>(attribute_.c_str());
+            inp.arg4 = const_cast<char*>(_node.hash.c_str());
+            inp.arg5 = const_cast<char*>(units.c_str());
+            const auto status = rsModAVUMetadata(comm_, &inp);
+            if(status < 0) {
+                THROW(
+                    status,
+                    boost::format("failed to write fingerprint of [%s]")
+                    % _collection);
+            }
+        } // write_node
+
+        std::string collection_fingerprint::hash_objects(
+            const std::string& _collection,
+            const std::string& _since,
+            node&              _node) {
+            std::string query_str {
+                boost::str(boost::format(
+                "SELECT DATA_NAME, DATA_CHECKSUM, DATA_SIZE, DATA_MODIFY_TIME, DATA_CREATE_TIME WHERE COLL_NAME = '%s'")
+                % escape_genquery_literal(_collection)) };
+
+            std::map<std::string, std::string> leaves;
+            std::set<std::string> names;
+            std::set<std::string> names_before;
+            for(const auto& row : query<rsComm_t>{comm_, query_str}) {
+                auto& leaf = leaves[row[0]];
+                if(leaf.empty() || !row[1].empty()) {
+                    leaf = object_leaf(row[0], row[1], row[2], row[3]);
+                }
+
+                names.insert(row[0]);
+                if(row[4] < _since) {
+                    names_before.insert(row[0]);
+                }
+            }
+
+            std::vector<std::string> parts;
+            for(auto& l : leaves) {
+                parts.push_back(std::move(l.second));
+            }
+
+            _node.objects_hash = digest(std::move(parts));
+            _node.names_hash   = names_digest(names);
+            return names_digest(names_before);
+        } // hash_objects
+
+        fingerprint_update collection_fingerprint::rebuild(
+            const std::string& _root) {
+            fingerprint_update result{true, true, false, {}};
+
+            // one pass over every object in the tree, one over every collection
+            std::map<std::string, std::map<std::string, std::string>> leaves;
+            std::map<std::string, std::size_t> objects;
+            std::string objects_query {
+                boost::str(boost::format(
+                "SELECT COLL_NAME, DATA_NAME, DATA_CHECKSUM, DATA_SIZE, DATA_MODIFY_TIME WHERE COLL_NAME = '%s' || like '%s/%%'")
+                % escape_genquery_literal(_root)
+                % escape_genquery_literal(_root)) };
+            for(const auto& row : query<rsComm_t>{comm_, objects_query}) {
+                auto& leaf = leaves[row[0]][row[1]];
+                if(leaf.empty() || !row[2].empty()) {
+                    leaf = object_leaf(row[1], row[2], row[3], row[4]);
+                }
+                ++objects[row[0]];
+            }
+
+            std::set<std::string> collections{_root};
+            std::map<std::string, std::size_t> subcollections;
+            std::string collections_query {
+                boost::str(boost::format(
+                "SELECT COLL_NAME WHERE COLL_NAME like '%s/%%'")
+                % escape_genquery_literal(_root)) };
+            for(const auto& row : query<rsComm_t>{comm_, collections_query}) {
+                if(collections.insert(row[0]).second) {
+                    ++subcollections[parent_of(row[0])];
+                }
+            }
+
+            std::map<std::string, std::map<std::string, std::string>> children;
+            for(const auto& coll : bottom_up(collections)) {
+                std::vector<std::string> parts;
+                std::set<std::string> names;
+                if(const auto itr = leaves.find(coll); itr != leaves.end()) {
+                    result.changed_collections.insert(coll);
+                    for(const auto& l : itr->second) {
+                        parts.push_back(l.second);
+                        names.insert(l.first);
+                    }
+                }
+
+                node n;
+                n.objects_hash = digest(std::move(parts));
+                n.names_hash   = names_digest(names);
+                n.hash         = node_hash(n.objects_hash, children[coll]);
+                n.computed_at  = now_;
+                n.objects      = count_of(objects, coll);
+                n.collections  = count_of(subcollections, coll);
+
+                if(coll != _root) {
+                    children[parent_of(coll)][coll] = n.hash;
+                }
+
+                pending_.emplace_back(coll, std::move(n));
+            }
+
+            return result;
+        } // rebuild
+
+        fingerprint_update collection_fingerprint::refresh(
+            const std::string& _root,
+            const node&        _root_node) {
+            fingerprint_update result;
+            const auto& since = _root_node.computed_at;
+
+            // the replicas and child collections each collection holds now,
+            // against which the stored counts reveal removals and moves
+            std::map<std::string, std::size_t> objects;
+            std::string objects_query {
+                boost::str(boost::format(
+                "SELECT COLL_NAME, COUNT(DATA_ID) WHERE COLL_NAME = '%s' || like '%s/%%'")
+                % escape_genquery_literal(_root)
+                % escape_genquery_literal(_root)) };
+            for(const auto& row : query<rsComm_t>{comm_, objects_query}) {
+                objects[row[0]] = std::stoull(row[1]);
+            }
+
+            std::map<std::string, std::size_t> subcollections;
+            std::string collections_query {
+                boost::str(boost::format(
+                "SELECT COLL_PARENT_NAME, COUNT(COLL_ID) WHERE COLL_PARENT_NAME = '%s' || like '%s/%%'")
+                % escape_genquery_literal(_root)
+                % escape_genquery_literal(_root)) };
+            for(const auto& row : query<rsComm_t>{comm_, collections_query}) {
+                subcollections[row[0]] = std::stoull(row[1]);
+            }
+
+            std::map<std::string, node> stored;
+            std::map<std::string, std::map<std::string, std::string>> stored_children;
+            std::string stored_query {
+                boost::str(boost::format(
+                "SELECT COLL_NAME, META_COLL_ATTR_VALUE, META_COLL_ATTR_UNITS WHERE META_COLL_ATTR_NAME = '%s' and COLL_NAME = '%s' || like '%s/%%'")
+                % escape_genquery_literal(attribute_)
+                % escape_genquery_literal(_root)
+                % escape_genquery_literal(_root)) };
+            for(const auto& row : query<rsComm_t>{comm_, stored_query}) {
+                node n;
+                if(parse_node(row[1], row[2], n)) {
+                    if(row[0] != _root) {
+                        stored_children[parent_of(row[0])][row[0]] = n.hash;
+                    }
+                    stored.emplace(row[0], std::move(n));
+                }
+            }
+
+            std::string changed_query {
+                boost::str(boost::format(
+                "SELECT COLL_NAME WHERE COLL_NAME = '%s' || like '%s/%%' AND DATA_MODIFY_TIME >= '%s'")
+                % escape_genquery_literal(_root)
+                % escape_genquery_literal(_root)
+                % escape_genquery_literal(since)) };
+            for(const auto& row : query<rsComm_t>{comm_, changed_query}) {
+                result.changed_collections.insert(row[0]);
+            }
+
+            // collections whose children changed are rehashed without
+            // rehashing their objects
+            std::set<std::string> affected;
+            for(const auto& s : stored) {
+                if(s.second.objects != count_of(objects, s.first)) {
+                    result.changed_collections.insert(s.first);
+                }
+
+                const auto children = count_of(subcollections, s.first);
+                if(s.second.collections != children) {
+                    affected.insert(s.first);
+                    // a child collection was removed or moved away
+                    result.removed = result.removed || children < s.second.collections;
+                }
+            }
+            for(const auto& o : objects) {
+                if(!stored.count(o.first)) {
+                    result.changed_collections.insert(o.first);
+                }
+            }
+
+            if(result.changed_collections.empty() && affected.empty()) {
+                return result;
+            }
+
+            // the changed collections and their ancestors are the only nodes to rehash
+            affected.insert(result.changed_collections.begin(), result.changed_collections.end());
+            for(const auto& c : std::set<std::string>{affected}) {
+                for(auto coll = c; coll != _root; ) {
+                    coll = parent_of(coll);
+                    if(!affected.insert(coll).second) {
+                        break;
+                    }
+                }
+            }
+
+            std::map<std::string, std::map<std::string, std::string>> computed;
+            std::string root_hash;
+            for(const auto& coll : bottom_up(affected)) {
+                const auto s = stored.find(coll);
+
+                node n;
+                if(result.changed_collections.count(coll) || s == stored.end()) {
+                    // an object present when the node was stored is missing
+                    // or has another name
+                    const auto names_before = hash_objects(coll, since, n);
+                    result.removed = result.removed ||
+                                     (s != stored.end() && names_before != s->second.names_hash);
+                }
+                else {
+                    n.objects_hash = s->second.objects_hash;
+                    n.names_hash   = s->second.names_hash;
+                }
+
+                // unchanged siblings contribute their stored nodes
+                auto children = stored_children[coll];
+                for(const auto& c : computed[coll]) {
+                    children[c.first] = c.second;
+                }
+
+                n.hash        = node_hash(n.objects_hash, children);
+                n.computed_at = now_;
+                n.objects     = count_of(objects, coll);
+                n.collections = count_of(subcollections, coll);
+
+                if(coll == _root) {
+                    root_hash = n.hash;
+                }
+                else {
+                    computed[parent_of(coll)][coll] = n.hash;
+                }
+
+                pending_.emplace_back(coll, std::move(n));
+            }
+
+            result.changed = result.removed || root_hash != _root_node.hash;
+            return result;
+        } // refresh
+    } // namespace publishing
+} // namespace irods
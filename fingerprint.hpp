@@ -0,0 +1,95 @@
+#ifndef FINGERPRINT_HPP
+#define FINGERPRINT_HPP
+
+#include <irods/rcConnect.h>
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace irods {
+    namespace publishing {
+        struct fingerprint_update {
+            // no fingerprint was stored, the whole tree was hashed
+            bool                  rebuilt{};
+            bool                  changed{};
+            // an object or collection was removed, renamed or moved away since
+            // the last fingerprint, which only a full comparison can undo
+            bool                  removed{};
+            // collections holding objects modified, added or removed since the
+            // last fingerprint
+            std::set<std::string> changed_collections;
+        }; // struct fingerprint_update
+
+        // a merkle tree over a collection hierarchy built from DATA_CHECKSUM.
+        // every collection carries its node as an AVU whose value is the hash
+        // of its objects and child nodes, and whose units hold the time it was
+        // computed, the number of its replicas and child collections, and the
+        // hashes of its objects and of their names.  an update descends only
+        // into collections with objects modified since then or whose counts
+        // differ and rehashes their ancestors from the stored nodes of the
+        // unchanged siblings.  nothing is stored until commit, so a caller
+        // which fails to act on the update sees the same changes again
+        class collection_fingerprint {
+            public:
+            collection_fingerprint(
+                rsComm_t*          _comm,
+                const std::string& _attribute);
+
+            fingerprint_update update(
+                const std::string& _root);
+
+            // store the nodes computed by the last update
+            void commit();
+
+            // forces the next update to rebuild the tree
+            void invalidate(
+                const std::string& _root);
+
+            private:
+            struct node {
+                std::string hash;
+                std::string objects_hash;
+                std::string names_hash;
+                std::string computed_at;
+                std::size_t objects{};
+                std::size_t collections{};
+            };
+
+            static bool parse_node(
+                const std::string& _value,
+                const std::string& _units,
+                node&              _node);
+
+            bool read_node(
+                const std::string& _collection,
+                node&              _node);
+
+            void write_node(
+                const std::string& _collection,
+                const node&        _node);
+
+            fingerprint_update rebuild(
+                const std::string& _root);
+
+            fingerprint_update refresh(
+                const std::string& _root,
+                const node&        _root_node);
+
+            // fills the object and name hashes of _node, and returns the hash
+            // of the names of objects created before _since
+            std::string hash_objects(
+                const std::string& _collection,
+                const std::string& _since,
+                node&              _node);
+
+            rsComm_t*                                 comm_;
+            const std::string                         attribute_;
+            std::string                               now_;
+            std::vector<std::pair<std::string, node>> pending_;
+        }; // class collection_fingerprint
+    } // namespace publishing
+} // namespace irods
+
+#endif // FINGERPRINT_HPP
@@ -0,0 +1,141 @@
+#ifndef GENQUERY_BUILDER_HPP
+#define GENQUERY_BUILDER_HPP
+
+#include <charconv>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace irods {
+    namespace publishing {
+        // _value with each single quote doubled, for placing between the
+        // quotes of a general query condition without ending the literal
+        inline std::string escape_genquery_literal(std::string_view _value) {
+            std::string escaped;
+            escaped.reserve(_value.size() + 2);
+            for(const auto c : _value) {
+                if('\'' == c) {
+                    escaped += '\'';
+                }
+                escaped += c;
+            }
+            return escaped;
+        } // escape_genquery_literal
+
+        // a value bound to a query condition, either text or an integer
+        class genquery_value {
+            public:
+            genquery_value(const char* _text) : text_{_text} {}
+            genquery_value(const std::string& _text) : text_{_text} {}
+            genquery_value(std::string_view _text) : text_{_text} {}
+            genquery_value(const uintmax_t _number) {
+                const auto r = std::to_chars(digits_, digits_ + sizeof(digits_), _number);
+                text_ = std::string_view{digits_, static_cast<std::size_t>(r.ptr - digits_)};
+            }
+
+            genquery_value(const genquery_value&) = delete;
+            genquery_value& operator=(const genquery_value&) = delete;
+
+            std::string_view text() const { return text_; }
+
+            private:
+            std::string_view text_;
+            char             digits_[24]{};
+        }; // class genquery_value
+
+        struct genquery_column {
+            int column;
+            int options{}; // 0, SELECT_COUNT, SELECT_SUM ...
+        }; // struct genquery_column
+
+        // a general query whose columns and condition clauses are fixed when
+        // the template is built.  each condition clause is written once with
+        // ? marking where the value bound to it is placed, e.g.
+        //     {COL_COLL_NAME, "= '?' || like '?/%'"}
+        // binding only splices the values into the pre-split clauses, nothing
+        // is formatted or parsed per call.  a quote in a bound value is
+        // doubled so a path holding one cannot end its literal early
+        class genquery_template {
+            public:
+            struct condition {
+                int         column;
+                std::string clause;
+            }; // struct condition
+
+            // a template with its values bound, ready to hand to the catalog
+            struct request {
+                const genquery_template*         source;
+                std::vector<std::pair<int, std::string>> conditions;
+
+                const std::vector<genquery_column>& select() const { return source->select_; }
+            }; // struct request
+
+            genquery_template(
+                std::vector<genquery_column> _select,
+                std::vector<condition>       _where) :
+                select_{std::move(_select)} {
+                for(auto& c : _where) {
+                    prepared p{c.column, {}, 0};
+                    std::string_view clause{c.clause};
+                    for(auto pos = clause.find('?'); ; pos = clause.find('?')) {
+                        p.segments.emplace_back(clause.substr(0, pos));
+                        p.literal_size += p.segments.back().size();
+                        if(std::string_view::npos == pos) {
+                            break;
+                        }
+                        clause.remove_prefix(pos + 1);
+                    }
+                    where_.push_back(std::move(p));
+                }
+            } // ctor
+
+            // bind one value per condition, in the order they were declared
+            template<typename... Values>
+            request bind(const Values&... _values) const {
+                const genquery_value values[] = {genquery_value{_values}...};
+                if(sizeof...(Values) != where_.size()) {
+                    throw std::invalid_argument{"genquery_template: wrong number of bound values"};
+                }
+
+                request r{this, {}};
+                r.conditions.reserve(where_.size());
+                const genquery_value* value = values;
+                std::string escaped;
+                for(const auto& p : where_) {
+                    auto text = value->text();
+                    if(std::string_view::npos != text.find('\'')) {
+                        escaped = escape_genquery_literal(text);
+                        text    = escaped;
+                    }
+
+                    std::string clause;
+                    clause.reserve(p.literal_size + (p.segments.size() - 1) * text.size());
+                    clause.append(p.segments.front());
+                    for(std::size_t i = 1; i < p.segments.size(); ++i) {
+                        clause.append(text);
+                        clause.append(p.segments[i]);
+                    }
+                    r.conditions.emplace_back(p.column, std::move(clause));
+                    ++value;
+                }
+
+                return r;
+            } // bind
+
+            private:
+            struct prepared {
+                int                      column;
+                std::vector<std::string> segments;
+                std::size_t              literal_size;
+            }; // struct prepared
+
+            std::vector<genquery_column> select_;
+            std::vector<prepared>        where_;
+        }; // class genquery_template
+    } // namespace publishing
+} // namespace irods
+
+#endif // GENQUERY_BUILDER_HPP
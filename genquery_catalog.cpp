@@ -0,0 +1,282 @@
+#include "genquery_catalog.hpp"
+
+#include "genquery_builder.hpp"
+
+#include <irods/rsGenQuery.hpp>
+#include <irods/rcMisc.h>
+#include <irods/rodsErrorTable.h>
+#include <irods/irods_exception.hpp>
+
+#define IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+#include <irods/filesystem.hpp>
+
+#include <boost/lexical_cast.hpp>
+
+namespace {
+    using irods::publishing::genquery_template;
+    using rows = std::vector<std::vector<std::string>>;
+
+    uintmax_t to_count(const std::string& _value) {
+        try {
+            return _value.empty() ? 0 : boost::lexical_cast<uintmax_t>(_value);
+        }
+        catch(const boost::bad_lexical_cast&) {
+            return 0;
+        }
+    } // to_count
+
+    // run a bound query built directly into the general query input, at most
+    // _limit rows are returned when it is not zero
+    rows execute(
+        rsComm_t*                         _comm,
+        const genquery_template::request& _request,
+        const std::size_t                 _limit = 0) {
+        genQueryInp_t inp{};
+        for(const auto& c : _request.select()) {
+            addInxIval(&inp.selectInp, c.column, c.options);
+        }
+        for(const auto& c : _request.conditions) {
+            addInxVal(&inp.sqlCondInp, c.first, c.second.c_str());
+        }
+        inp.maxRows = _limit > 0 && _limit < MAX_SQL_ROWS ? static_cast<int>(_limit) : MAX_SQL_ROWS;
+
+        rows results;
+        genQueryOut_t* out{};
+        int status{};
+        while(true) {
+            status = rsGenQuery(_comm, &inp, &out);
+            if(status < 0) {
+                freeGenQueryOut(&out);
+                break;
+            }
+
+            for(int row = 0; row < out->rowCnt; ++row) {
+                std::vector<std::string> values;
+                values.reserve(out->attriCnt);
+                for(int attr = 0; attr < out->attriCnt; ++attr) {
+                    values.emplace_back(out->sqlResult[attr].value + row * out->sqlResult[attr].len);
+                }
+                results.push_back(std::move(values));
+            }
+
+            const bool done = 0 == out->continueInx ||
+                              (_limit > 0 && results.size() >= _limit);
+            inp.continueInx = out->continueInx;
+            freeGenQueryOut(&out);
+            if(done) {
+                break;
+            }
+        }
+
+        if(inp.continueInx > 0) {
+            // release the statement held open for the rows we did not read
+            inp.maxRows = 0;
+            rsGenQuery(_comm, &inp, &out);
+            freeGenQueryOut(&out);
+        }
+
+        clearGenQueryInp(&inp);
+
+        if(status < 0 && CAT_NO_ROWS_FOUND != status) {
+            THROW(
+                status,
+                "general query failed");
+        }
+
+        return results;
+    } // execute
+
+    const genquery_template object_metadata_query{
+        {{COL_META_DATA_ATTR_VALUE}, {COL_META_DATA_ATTR_UNITS}},
+        {{COL_META_DATA_ATTR_NAME, "= '?'"},
+         {COL_COLL_NAME,           "= '?'"},
+         {COL_DATA_NAME,           "= '?'"}}};
+
+    const genquery_template collection_metadata_query{
+        {{COL_META_COLL_ATTR_VALUE}, {COL_META_COLL_ATTR_UNITS}},
+        {{COL_META_COLL_ATTR_NAME, "= '?'"},
+         {COL_COLL_NAME,           "= '?'"}}};
+
+    const genquery_template annotated_objects_query{
+        {{COL_COLL_NAME}, {COL_DATA_NAME}},
+        {{COL_META_DATA_ATTR_NAME, "= '?'"},
+         {COL_COLL_NAME,           "= '?'"}}};
+
+    const genquery_template annotated_collections_query{
+        {{COL_COLL_NAME}},
+        {{COL_META_COLL_ATTR_NAME, "= '?'"}}};
+
+    const genquery_template all_annotated_objects_query{
+        {{COL_COLL_NAME}, {COL_DATA_NAME}},
+        {{COL_META_DATA_ATTR_NAME, "= '?'"}}};
+
+    const genquery_template user_metadata_query{
+        {{COL_META_USER_ATTR_VALUE}},
+        {{COL_USER_NAME,           "= '?'"},
+         {COL_META_USER_ATTR_NAME, "= '?'"}}};
+
+    // a single aggregate query over the whole subtree, counts every replica
+    const genquery_template collection_size_query{
+        {{COL_D_DATA_ID, SELECT_COUNT}, {COL_DATA_SIZE, SELECT_SUM}},
+        {{COL_COLL_NAME, "= '?' || like '?/%'"}}};
+
+    const genquery_template collection_listing_query{
+        {{COL_COLL_NAME}, {COL_DATA_NAME}},
+        {{COL_COLL_NAME, "= '?'"}}};
+
+    const genquery_template recursive_collection_listing_query{
+        {{COL_COLL_NAME}, {COL_DATA_NAME}},
+        {{COL_COLL_NAME, "= '?' || like '?/%'"}}};
+
+    const genquery_template delayed_rule_count_query{
+        {{COL_RULE_EXEC_ID, SELECT_COUNT}},
+        {{COL_RULE_EXEC_NAME, "like '%?%'"}}};
+
+    const genquery_template delayed_rule_list_query{
+        {{COL_RULE_EXEC_TIME, ORDER_BY}, {COL_RULE_EXEC_ID}, {COL_RULE_EXEC_NAME}},
+        {{COL_RULE_EXEC_NAME, "like '%?%'"}}};
+} // namespace
+
+namespace irods {
+    namespace publishing {
+        catalog::metadata_results genquery_catalog::object_metadata(
+            const std::string& _object_path,
+            const std::string& _attribute) {
+            namespace fs = irods::experimental::filesystem;
+            fs::path p{_object_path};
+
+            count_query();
+            metadata_results results;
+            for(auto& row : execute(comm_, object_metadata_query.bind(
+                                               _attribute,
+                                               p.parent_path().string(),
+                                               p.object_name().string()))) {
+                results.emplace_back(std::move(row[0]), std::move(row[1]));
+            }
+
+            return results;
+        } // object_metadata
+
+        catalog::metadata_results genquery_catalog::collection_metadata(
+            const std::string& _collection_name,
+            const std::string& _attribute) {
+            count_query();
+            metadata_results results;
+            for(auto& row : execute(comm_, collection_metadata_query.bind(
+                                               _attribute,
+                                               _collection_name))) {
+                results.emplace_back(std::move(row[0]), std::move(row[1]));
+            }
+
+            return results;
+        } // collection_metadata
+
+        std::vector<std::string> genquery_catalog::user_metadata(
+            const std::string& _user_name,
+            const std::string& _attribute) {
+            count_query();
+            std::vector<std::string> results;
+            for(auto& row : execute(comm_, user_metadata_query.bind(
+                                               _user_name,
+                                               _attribute))) {
+                results.push_back(std::move(row[0]));
+            }
+
+            return results;
+        } // user_metadata
+
+        std::vector<std::string> genquery_catalog::objects_with_metadata(
+            const std::string& _collection_name,
+            const std::string& _attribute) {
+            count_query();
+            std::vector<std::string> paths;
+            for(const auto& row : execute(comm_, annotated_objects_query.bind(
+                                                     _attribute,
+                                                     _collection_name))) {
+                paths.push_back(row[0] + "/" + row[1]);
+            }
+
+            return paths;
+        } // objects_with_metadata
+
+        std::vector<std::string> genquery_catalog::paths_with_metadata(
+            const std::string& _attribute) {
+            std::vector<std::string> paths;
+
+            count_query();
+            for(auto& row : execute(comm_, annotated_collections_query.bind(_attribute))) {
+                paths.push_back(std::move(row[0]));
+            }
+
+            count_query();
+            for(const auto& row : execute(comm_, all_annotated_objects_query.bind(_attribute))) {
+                paths.push_back(row[0] + "/" + row[1]);
+            }
+
+            return paths;
+        } // paths_with_metadata
+
+        bool genquery_catalog::is_data_object(
+            const std::string& _path) {
+            namespace fsvr = irods::experimental::filesystem::server;
+            count_query();
+            return fsvr::is_data_object(*comm_, _path);
+        } // is_data_object
+
+        uintmax_t genquery_catalog::data_object_size(
+            const std::string& _object_path) {
+            namespace fsvr = irods::experimental::filesystem::server;
+            count_query();
+            return fsvr::data_object_size(*comm_, _object_path);
+        } // data_object_size
+
+        job_size_estimate genquery_catalog::collection_size(
+            const std::string& _collection_name) {
+            count_query();
+            const auto rows = execute(comm_, collection_size_query.bind(_collection_name), 1);
+
+            job_size_estimate estimate{};
+            if(!rows.empty()) {
+                estimate.objects = to_count(rows.front()[0]);
+                estimate.bytes   = to_count(rows.front()[1]);
+            }
+
+            return estimate;
+        } // collection_size
+
+        std::vector<std::string> genquery_catalog::list_data_objects(
+            const std::string& _collection_name,
+            const bool         _recursive) {
+            const auto& listing = _recursive ?
+                                  recursive_collection_listing_query :
+                                  collection_listing_query;
+
+            count_query();
+            std::vector<std::string> paths;
+            for(const auto& row : execute(comm_, listing.bind(_collection_name))) {
+                paths.push_back(row[0] + "/" + row[1]);
+            }
+
+            return paths;
+        } // list_data_objects
+
+        uintmax_t genquery_catalog::count_delayed_rules(
+            const std::string& _name_fragment) {
+            count_query();
+            const auto rows = execute(comm_, delayed_rule_count_query.bind(_name_fragment), 1);
+            return rows.empty() ? 0 : to_count(rows.front()[0]);
+        } // count_delayed_rules
+
+        std::vector<delayed_rule> genquery_catalog::list_delayed_rules(
+            const std::string& _name_fragment,
+            const std::size_t  _limit) {
+            count_query();
+            std::vector<delayed_rule> rules;
+            for(auto& row : execute(comm_, delayed_rule_list_query.bind(_name_fragment), _limit)) {
+                rules.push_back({std::move(row[1]), std::move(row[2]), std::move(row[0])});
+            }
+
+            return rules;
+        } // list_delayed_rules
+    } // namespace publishing
+} // namespace irods
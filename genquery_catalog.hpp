@@ -0,0 +1,61 @@
+#ifndef GENQUERY_CATALOG_HPP
+#define GENQUERY_CATALOG_HPP
+
+#include "catalog.hpp"
+
+#include <irods/rcConnect.h>
+
+namespace irods {
+    namespace publishing {
+        // the catalog as seen by a server agent, each lookup issues a single
+        // general query or api call and failures raise irods::exception
+        class genquery_catalog : public catalog {
+            public:
+            explicit genquery_catalog(rsComm_t* _comm) : comm_{_comm} {}
+
+            metadata_results object_metadata(
+                const std::string& _object_path,
+                const std::string& _attribute) override;
+
+            metadata_results collection_metadata(
+                const std::string& _collection_name,
+                const std::string& _attribute) override;
+
+            std::vector<std::string> user_metadata(
+                const std::string& _user_name,
+                const std::string& _attribute) override;
+
+            std::vector<std::string> objects_with_metadata(
+                const std::string& _collection_name,
+                const std::string& _attribute) override;
+
+            std::vector<std::string> paths_with_metadata(
+                const std::string& _attribute) override;
+
+            bool is_data_object(
+                const std::string& _path) override;
+
+            uintmax_t data_object_size(
+                const std::string& _object_path) override;
+
+            job_size_estimate collection_size(
+                const std::string& _collection_name) override;
+
+            std::vector<std::string> list_data_objects(
+                const std::string& _collection_name,
+                const bool         _recursive) override;
+
+            uintmax_t count_delayed_rules(
+                const std::string& _name_fragment) override;
+
+            std::vector<delayed_rule> list_delayed_rules(
+                const std::string& _name_fragment,
+                const std::size_t  _limit) override;
+
+            private:
+            rsComm_t* comm_;
+        }; // class genquery_catalog
+    } // namespace publishing
+} // namespace irods
+
+#endif // GENQUERY_CATALOG_HPP
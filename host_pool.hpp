@@ -0,0 +1,186 @@
+#ifndef HOST_POOL_HPP
+#define HOST_POOL_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace irods {
+    namespace publishing {
+        // a set of equivalent service endpoints which requests are spread across.
+        // a host which fails _failure_threshold consecutive requests is skipped
+        // for _retry_interval, after which it is offered again and restored by
+        // its next success.  when every host is unhealthy the one which has
+        // waited longest is used rather than failing the request outright
+        class host_pool {
+        public:
+            using clock = std::chrono::steady_clock;
+
+            enum class selection { round_robin, least_outstanding };
+
+            static selection to_selection(const std::string& _name) {
+                if("round_robin" == _name) {
+                    return selection::round_robin;
+                }
+                if("least_outstanding" == _name) {
+                    return selection::least_outstanding;
+                }
+                throw std::invalid_argument{"unknown host selection [" + _name + "]"};
+            } // to_selection
+
+            // a host reserved for a single request, released on destruction
+            class lease {
+            public:
+                lease(host_pool& _pool, std::size_t _index, std::string _url) :
+                    pool_{&_pool}, index_{_index}, url_{std::move(_url)} {}
+
+                lease(lease&& _other) noexcept :
+                    pool_{_other.pool_}, index_{_other.index_}, url_{std::move(_other.url_)} {
+                    _other.pool_ = nullptr;
+                }
+
+                lease(const lease&) = delete;
+                lease& operator=(const lease&) = delete;
+                lease& operator=(lease&&) = delete;
+
+                ~lease() {
+                    if(pool_) {
+                        pool_->release(index_, nullptr);
+                    }
+                }
+
+                const std::string& url() const { return url_; }
+
+                void succeeded() { report(true); }
+                void failed()    { report(false); }
+
+            private:
+                void report(const bool _success) {
+                    if(pool_) {
+                        pool_->release(index_, &_success);
+                        pool_ = nullptr;
+                    }
+                }
+
+                host_pool*  pool_;
+                std::size_t index_;
+                std::string url_;
+            }; // class lease
+
+            host_pool(
+                const std::vector<std::string>& _urls,
+                const selection                 _selection,
+                const unsigned                  _failure_threshold,
+                const clock::duration           _retry_interval) :
+                selection_{_selection},
+                failure_threshold_{std::max(1u, _failure_threshold)},
+                retry_interval_{_retry_interval} {
+                if(_urls.empty()) {
+                    throw std::invalid_argument{"host pool requires at least one host"};
+                }
+
+                for(auto url : _urls) {
+                    while(!url.empty() && '/' == url.back()) {
+                        url.pop_back();
+                    }
+                    hosts_.push_back(host{url});
+                }
+            } // ctor
+
+            std::size_t size() const { return hosts_.size(); }
+
+            lease acquire(const clock::time_point _now = clock::now()) {
+                std::lock_guard<std::mutex> lock{mutex_};
+                const std::size_t index = select(_now);
+                ++hosts_[index].outstanding;
+                return lease{*this, index, hosts_[index].url};
+            } // acquire
+
+            bool healthy(const std::size_t _index, const clock::time_point _now = clock::now()) const {
+                std::lock_guard<std::mutex> lock{mutex_};
+                return available(hosts_[_index], _now);
+            } // healthy
+
+        private:
+            struct host {
+                std::string       url;
+                std::size_t       outstanding{};
+                unsigned          failures{};
+                clock::time_point unhealthy_until{};
+            }; // struct host
+
+            bool available(const host& _h, const clock::time_point _now) const {
+                return _h.failures < failure_threshold_ || _h.unhealthy_until <= _now;
+            } // available
+
+            std::size_t select(const clock::time_point _now) {
+                const std::size_t count = hosts_.size();
+                std::size_t best  = count;
+                std::size_t least = std::numeric_limits<std::size_t>::max();
+
+                for(std::size_t i = 0; i < count; ++i) {
+                    // start after the previous choice so ties rotate between hosts
+                    const std::size_t index = (next_ + i) % count;
+                    const auto& h = hosts_[index];
+                    if(!available(h, _now)) {
+                        continue;
+                    }
+
+                    if(selection::round_robin == selection_) {
+                        best = index;
+                        break;
+                    }
+
+                    if(h.outstanding < least) {
+                        least = h.outstanding;
+                        best  = index;
+                    }
+                }
+
+                if(count == best) {
+                    best = 0;
+                    for(std::size_t i = 1; i < count; ++i) {
+                        if(hosts_[i].unhealthy_until < hosts_[best].unhealthy_until) {
+                            best = i;
+                        }
+                    }
+                }
+
+                next_ = (best + 1) % count;
+                return best;
+            } // select
+
+            void release(const std::size_t _index, const bool* _success) {
+                std::lock_guard<std::mutex> lock{mutex_};
+                auto& h = hosts_[_index];
+                --h.outstanding;
+                if(!_success) {
+                    return;
+                }
+
+                if(*_success) {
+                    h.failures = 0;
+                    return;
+                }
+
+                if(++h.failures >= failure_threshold_) {
+                    h.unhealthy_until = clock::now() + retry_interval_;
+                }
+            } // release
+
+            const selection       selection_;
+            const unsigned        failure_threshold_;
+            const clock::duration retry_interval_;
+            mutable std::mutex    mutex_;
+            std::vector<host>     hosts_;
+            std::size_t           next_{};
+        }; // class host_pool
+    } // namespace publishing
+} // namespace irods
+
+#endif // HOST_POOL_HPP
@@ -0,0 +1,54 @@
+#include "job_slot.hpp"
+
+#include <irods/rodsLog.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace irods {
+    namespace publishing {
+        job_slot::job_slot(
+            const std::string& _lane,
+            const int          _maximum_concurrency) {
+            // a non-positive limit leaves the lane unthrottled
+            if(_maximum_concurrency <= 0) {
+                fd_ = ::open("/dev/null", O_RDONLY);
+                return;
+            }
+
+            const auto dir = boost::filesystem::temp_directory_path();
+            for(int i = 0; i < _maximum_concurrency; ++i) {
+                const auto slot_path = dir / boost::str(
+                                           boost::format("irods_publishing_%s_slot_%d.lock")
+                                           % _lane
+                                           % i);
+                const int fd = ::open(slot_path.c_str(), O_CREAT | O_RDWR, 0600);
+                if(fd < 0) {
+                    rodsLog(
+                        LOG_ERROR,
+                        "job_slot failed to open [%s]",
+                        slot_path.c_str());
+                    continue;
+                }
+
+                if(0 == ::flock(fd, LOCK_EX | LOCK_NB)) {
+                    fd_ = fd;
+                    return;
+                }
+
+                ::close(fd);
+            } // for i
+        } // ctor
+
+        job_slot::~job_slot() {
+            if(fd_ >= 0) {
+                // closing the descriptor releases the lock
+                ::close(fd_);
+            }
+        } // dtor
+    } // namespace publishing
+} // namespace irods
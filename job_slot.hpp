@@ -0,0 +1,28 @@
+#ifndef JOB_SLOT_HPP
+#define JOB_SLOT_HPP
+
+#include <string>
+
+namespace irods {
+    namespace publishing {
+        // a cross process counting semaphore built on advisory file locks, the
+        // kernel releases the lock should an agent die while holding a slot
+        class job_slot {
+            public:
+            job_slot(
+                const std::string& _lane,
+                const int          _maximum_concurrency);
+            ~job_slot();
+
+            job_slot(const job_slot&) = delete;
+            job_slot& operator=(const job_slot&) = delete;
+
+            bool acquired() const { return fd_ >= 0; }
+
+            private:
+            int fd_{-1};
+        }; // class job_slot
+    } // namespace publishing
+} // namespace irods
+
+#endif // JOB_SLOT_HPP
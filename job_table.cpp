@@ -0,0 +1,320 @@
+#include "job_table.hpp"
+
+#include "shared_segment.hpp"
+
+#include <irods/rodsErrorTable.h>
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace {
+    uint64_t now() noexcept {
+        using namespace std::chrono;
+        return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+    } // now
+
+    template<std::size_t N>
+    void copy_string(char (&_dst)[N], const std::string& _src) noexcept {
+        const auto n = std::min(_src.size(), N - 1);
+        std::memcpy(_dst, _src.data(), n);
+        _dst[n] = '\0';
+    } // copy_string
+
+    template<std::size_t N>
+    std::string read_string(const char (&_src)[N]) {
+        return std::string{_src, ::strnlen(_src, N)};
+    } // read_string
+
+    bool agent_exists(const int _pid) noexcept {
+        return _pid > 0 && (0 == ::kill(_pid, 0) || EPERM == errno);
+    } // agent_exists
+} // namespace
+
+namespace irods {
+    namespace publishing {
+        std::string to_string(const job_table::state _state) {
+            switch(_state) {
+                case job_table::state::free:      return "free";
+                case job_table::state::claimed:   return "claimed";
+                case job_table::state::running:   return "running";
+                case job_table::state::completed: return "completed";
+                case job_table::state::failed:    return "failed";
+                case job_table::state::cancelled: return "cancelled";
+            }
+            return "unknown";
+        } // to_string
+
+        job_table::job_table(const std::string& _instance_name) {
+            // the size is part of the name so agents built with a different
+            // layout never share a table
+            segment_ = static_cast<segment*>(map_shared_segment(
+                           boost::str(boost::format("irods_publishing_jobs_%s_%u.shm")
+                           % _instance_name
+                           % sizeof(segment)),
+                           sizeof(segment)));
+        } // ctor
+
+        job_table::~job_table() {
+            unmap_shared_segment(segment_, sizeof(segment));
+        } // dtor
+
+        bool job_table::claim(slot& _slot, const uint32_t _expected) noexcept {
+            auto expected = _expected;
+            if(!_slot.status.compare_exchange_strong(expected, static_cast<uint32_t>(state::claimed))) {
+                return false;
+            }
+
+            _slot.pid.store(::getpid());
+            return true;
+        } // claim
+
+        job_table::handle job_table::start(
+            const std::string& _operation,
+            const std::string& _path,
+            const std::string& _publisher,
+            const std::string& _user,
+            const uintmax_t    _bytes_total,
+            const uintmax_t    _objects_total) noexcept {
+            if(!segment_) {
+                return {};
+            }
+
+            auto& slots = segment_->slots;
+            std::size_t index = capacity;
+            for(std::size_t i = 0; i < capacity && capacity == index; ++i) {
+                if(claim(slots[i], static_cast<uint32_t>(state::free))) {
+                    index = i;
+                }
+            }
+
+            // evict the job which finished longest ago, or whose agent is gone.
+            // a claimed slot is never taken, its pid is stored only after the
+            // claim and may still be that of the job it replaced.  another
+            // agent may evict the same slot first, so try a few times
+            for(int attempt = 0; attempt < 3 && capacity == index; ++attempt) {
+                std::size_t oldest = capacity;
+                uint32_t    oldest_status{};
+                uint64_t    oldest_update{};
+                for(std::size_t i = 0; i < capacity; ++i) {
+                    const auto s = slots[i].status.load();
+                    const bool finished =
+                        static_cast<uint32_t>(state::completed) == s ||
+                        static_cast<uint32_t>(state::failed) == s ||
+                        static_cast<uint32_t>(state::cancelled) == s ||
+                        (static_cast<uint32_t>(state::running) == s && !agent_exists(slots[i].pid.load()));
+                    const auto updated = slots[i].updated_at.load();
+                    if(finished && (capacity == oldest || updated < oldest_update)) {
+                        oldest        = i;
+                        oldest_status = s;
+                        oldest_update = updated;
+                    }
+                }
+
+                if(capacity == oldest) {
+                    break;
+                }
+
+                if(claim(slots[oldest], oldest_status)) {
+                    index = oldest;
+                }
+            }
+
+            if(capacity == index) {
+                return {};
+            }
+
+            auto& s = slots[index];
+            const auto started = now();
+            s.sequence.fetch_add(1, std::memory_order_acq_rel);
+            s.error.store(0, std::memory_order_relaxed);
+            s.cancel_requested.store(0, std::memory_order_relaxed);
+            s.started_at.store(started, std::memory_order_relaxed);
+            s.updated_at.store(started, std::memory_order_relaxed);
+            s.bytes_total.store(_bytes_total, std::memory_order_relaxed);
+            s.bytes_done.store(0, std::memory_order_relaxed);
+            s.objects_total.store(_objects_total, std::memory_order_relaxed);
+            s.objects_done.store(0, std::memory_order_relaxed);
+            copy_string(s.operation, _operation);
+            copy_string(s.path, _path);
+            copy_string(s.publisher, _publisher);
+            copy_string(s.user, _user);
+            copy_string(s.message, {});
+            s.sequence.fetch_add(1, std::memory_order_release);
+            s.status.store(static_cast<uint32_t>(state::running));
+
+            return handle{this, index};
+        } // start
+
+        void job_table::finish(
+            const std::size_t  _slot,
+            const state        _status,
+            const int          _error,
+            const std::string& _message) noexcept {
+            auto& s = segment_->slots[_slot];
+            s.sequence.fetch_add(1, std::memory_order_acq_rel);
+            s.error.store(_error, std::memory_order_relaxed);
+            s.updated_at.store(now(), std::memory_order_relaxed);
+            copy_string(s.message, _message);
+            s.sequence.fetch_add(1, std::memory_order_release);
+            s.status.store(static_cast<uint32_t>(_status));
+        } // finish
+
+        bool job_table::read(const slot& _slot, job& _job) const {
+            // an agent which died mid write leaves the sequence odd, so the
+            // number of attempts is bounded
+            for(int attempt = 0; attempt < 64; ++attempt) {
+                const auto before = _slot.sequence.load(std::memory_order_acquire);
+                if(before & 1) {
+                    continue;
+                }
+
+                _job.status           = static_cast<state>(_slot.status.load(std::memory_order_relaxed));
+                _job.pid              = _slot.pid.load(std::memory_order_relaxed);
+                _job.error            = _slot.error.load(std::memory_order_relaxed);
+                _job.cancel_requested = 0 != _slot.cancel_requested.load(std::memory_order_relaxed);
+                _job.started_at       = _slot.started_at.load(std::memory_order_relaxed);
+                _job.updated_at       = _slot.updated_at.load(std::memory_order_relaxed);
+                _job.bytes_total      = _slot.bytes_total.load(std::memory_order_relaxed);
+                _job.bytes_done       = _slot.bytes_done.load(std::memory_order_relaxed);
+                _job.objects_total    = _slot.objects_total.load(std::memory_order_relaxed);
+                _job.objects_done     = _slot.objects_done.load(std::memory_order_relaxed);
+                _job.operation        = read_string(_slot.operation);
+                _job.path             = read_string(_slot.path);
+                _job.publisher        = read_string(_slot.publisher);
+                _job.user             = read_string(_slot.user);
+                _job.message          = read_string(_slot.message);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(before == _slot.sequence.load(std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+
+            return false;
+        } // read
+
+        std::vector<job_table::job> job_table::jobs() const {
+            std::vector<job> results;
+            if(!segment_) {
+                return results;
+            }
+
+            for(const auto& s : segment_->slots) {
+                job j{};
+                if(!read(s, j) || state::free == j.status || state::claimed == j.status) {
+                    continue;
+                }
+
+                if(state::running == j.status && !agent_exists(j.pid)) {
+                    j.status  = state::failed;
+                    j.message = "the agent executing the job exited before it finished";
+                }
+
+                results.push_back(std::move(j));
+            }
+
+            return results;
+        } // jobs
+
+        std::size_t job_table::cancel(const std::string& _path) noexcept {
+            if(!segment_) {
+                return 0;
+            }
+
+            std::size_t count{};
+            for(auto& s : segment_->slots) {
+                if(static_cast<uint32_t>(state::running) != s.status.load()) {
+                    continue;
+                }
+
+                job j{};
+                try {
+                    if(!read(s, j)) {
+                        continue;
+                    }
+                }
+                catch(const std::bad_alloc&) {
+                    break;
+                }
+
+                const bool beneath = j.path.size() > _path.size() &&
+                                     '/' == j.path[_path.size()] &&
+                                     0 == j.path.compare(0, _path.size(), _path);
+                if(state::running == j.status && (j.path == _path || beneath)) {
+                    s.cancel_requested.store(1);
+                    ++count;
+                }
+            }
+
+            return count;
+        } // cancel
+
+        job_table::handle::handle(handle&& _other) noexcept :
+              table_{_other.table_}
+            , slot_{_other.slot_} {
+            _other.table_ = nullptr;
+        } // move ctor
+
+        job_table::handle& job_table::handle::operator=(handle&& _other) noexcept {
+            if(this != &_other) {
+                fail(SYS_INTERNAL_ERR, "the job ended without completing");
+                table_ = _other.table_;
+                slot_  = _other.slot_;
+                _other.table_ = nullptr;
+            }
+            return *this;
+        } // move assignment
+
+        job_table::handle::~handle() {
+            fail(SYS_INTERNAL_ERR, "the job ended without completing");
+        } // dtor
+
+        void job_table::handle::progress(
+            const uintmax_t _bytes,
+            const uintmax_t _objects) noexcept {
+            if(!table_) {
+                return;
+            }
+
+            auto& s = table_->segment_->slots[slot_];
+            s.bytes_done.fetch_add(_bytes, std::memory_order_relaxed);
+            s.objects_done.fetch_add(_objects, std::memory_order_relaxed);
+            s.updated_at.store(now(), std::memory_order_relaxed);
+        } // progress
+
+        void job_table::handle::complete() noexcept {
+            if(table_) {
+                table_->finish(slot_, state::completed, 0, {});
+                table_ = nullptr;
+            }
+        } // complete
+
+        bool job_table::handle::cancel_requested() const noexcept {
+            return table_ && 0 != table_->segment_->slots[slot_].cancel_requested.load(std::memory_order_relaxed);
+        } // cancel_requested
+
+        void job_table::handle::mark_cancelled() noexcept {
+            if(table_) {
+                table_->finish(slot_, state::cancelled, 0, "cancelled on request");
+                table_ = nullptr;
+            }
+        } // mark_cancelled
+
+        void job_table::handle::fail(
+            const int          _error,
+            const std::string& _message) noexcept {
+            if(table_) {
+                table_->finish(slot_, state::failed, _error, _message);
+                table_ = nullptr;
+            }
+        } // fail
+    } // namespace publishing
+} // namespace irods
@@ -0,0 +1,154 @@
+#ifndef JOB_TABLE_HPP
+#define JOB_TABLE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace irods {
+    namespace publishing {
+        // the publication jobs currently running on this host and those which
+        // most recently finished.  the table lives in a file mapped by every
+        // agent, so the delay server agents executing the jobs record their
+        // progress where the agent answering a status request can read it.
+        // a slot is written only by the agent which claimed it, readers take
+        // a consistent copy by retrying while the slot's sequence changes.
+        // any agent may ask a running job to stop by raising its cancel flag,
+        // which the job polls between objects
+        class job_table {
+            public:
+            static constexpr std::size_t capacity     = 256;
+            static constexpr std::size_t path_size    = 1088;
+            static constexpr std::size_t name_size    = 64;
+            static constexpr std::size_t message_size = 256;
+
+            enum class state : uint32_t {
+                free, claimed, running, completed, failed, cancelled
+            };
+
+            struct job {
+                state       status;
+                std::string operation;
+                std::string path;
+                std::string publisher;
+                std::string user;
+                int         pid;
+                uint64_t    started_at; // microseconds since the epoch
+                uint64_t    updated_at;
+                uintmax_t   bytes_total;
+                uintmax_t   bytes_done;
+                uintmax_t   objects_total;
+                uintmax_t   objects_done;
+                int         error;
+                std::string message;
+                bool        cancel_requested;
+            }; // struct job
+
+            // a claimed slot, released as failed should the job end without
+            // being marked complete, e.g. by an exception
+            class handle {
+                public:
+                handle() = default;
+                handle(handle&& _other) noexcept;
+                handle& operator=(handle&& _other) noexcept;
+                ~handle();
+
+                handle(const handle&) = delete;
+                handle& operator=(const handle&) = delete;
+
+                // false when the table was unavailable or full, every call is then a no-op
+                explicit operator bool() const noexcept { return nullptr != table_; }
+
+                void progress(
+                    const uintmax_t _bytes,
+                    const uintmax_t _objects = 1) noexcept;
+
+                void complete() noexcept;
+
+                // true once another agent has asked the job to stop
+                bool cancel_requested() const noexcept;
+
+                // the job stopped early at the request of another agent
+                void mark_cancelled() noexcept;
+
+                void fail(
+                    const int          _error,
+                    const std::string& _message) noexcept;
+
+                private:
+                friend class job_table;
+                handle(job_table* _table, std::size_t _slot) : table_{_table}, slot_{_slot} {}
+
+                job_table*  table_{};
+                std::size_t slot_{};
+            }; // class handle
+
+            explicit job_table(const std::string& _instance_name);
+            ~job_table();
+
+            job_table(const job_table&) = delete;
+            job_table& operator=(const job_table&) = delete;
+
+            // claim a slot for a job starting now, evicting the job which
+            // finished longest ago when no slot is free
+            handle start(
+                const std::string& _operation,
+                const std::string& _path,
+                const std::string& _publisher,
+                const std::string& _user,
+                const uintmax_t    _bytes_total,
+                const uintmax_t    _objects_total) noexcept;
+
+            // a consistent copy of every occupied slot.  a running job whose
+            // agent no longer exists is reported as failed
+            std::vector<job> jobs() const;
+
+            // ask the running jobs for _path, and for anything beneath it,
+            // to stop.  returns the number of jobs asked
+            std::size_t cancel(const std::string& _path) noexcept;
+
+            private:
+            struct slot {
+                std::atomic<uint32_t>  status;
+                std::atomic<uint32_t>  sequence; // odd while the slot is being written
+                std::atomic<int32_t>   pid;
+                std::atomic<int32_t>   error;
+                std::atomic<uint32_t>  cancel_requested;
+                std::atomic<uint64_t>  started_at;
+                std::atomic<uint64_t>  updated_at;
+                std::atomic<uintmax_t> bytes_total;
+                std::atomic<uintmax_t> bytes_done;
+                std::atomic<uintmax_t> objects_total;
+                std::atomic<uintmax_t> objects_done;
+                char                   operation[name_size];
+                char                   path[path_size];
+                char                   publisher[name_size];
+                char                   user[name_size];
+                char                   message[message_size];
+            }; // struct slot
+
+            struct segment {
+                slot slots[capacity];
+            }; // struct segment
+
+            bool claim(slot& _slot, const uint32_t _expected) noexcept;
+
+            // a consistent copy of the slot, false when none could be taken
+            bool read(const slot& _slot, job& _job) const;
+
+            void finish(
+                const std::size_t  _slot,
+                const state        _status,
+                const int          _error,
+                const std::string& _message) noexcept;
+
+            segment* segment_{};
+        }; // class job_table
+
+        std::string to_string(const job_table::state _state);
+    } // namespace publishing
+} // namespace irods
+
+#endif // JOB_TABLE_HPP
@@ -0,0 +1,92 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace irods {
+    namespace publishing {
+        // an hdr style log linear histogram of microsecond latencies: values
+        // below 4us are exact and every power of two above is split into four
+        // sub buckets, bounding the relative error at 25% up to about 19 hours.
+        // counters are lock free atomics with no pointers so the histogram may
+        // live in memory shared between agents, all zeros is the empty state
+        class latency_histogram {
+            public:
+            static constexpr unsigned    sub_bucket_bits  = 2;
+            static constexpr unsigned    sub_bucket_count = 1u << sub_bucket_bits;
+            static constexpr unsigned    maximum_msb      = 36;
+            static constexpr std::size_t bucket_count     = sub_bucket_count * maximum_msb;
+
+            static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                          "shared histograms require lock free 64 bit atomics");
+
+            static constexpr std::size_t bucket_index(const uint64_t _micros) noexcept {
+                if(_micros < sub_bucket_count) {
+                    return static_cast<std::size_t>(_micros);
+                }
+
+                unsigned msb = 63;
+                while(!(_micros >> msb)) { --msb; }
+                if(msb >= maximum_msb) {
+                    return bucket_count - 1;
+                }
+
+                const unsigned shift = msb - sub_bucket_bits;
+                return (msb - sub_bucket_bits + 1) * sub_bucket_count +
+                       static_cast<std::size_t>((_micros >> shift) & (sub_bucket_count - 1));
+            } // bucket_index
+
+            // the smallest value which falls beyond bucket _index
+            static constexpr uint64_t bucket_upper_bound(const std::size_t _index) noexcept {
+                if(_index < sub_bucket_count) {
+                    return _index + 1;
+                }
+
+                const std::size_t octave = _index / sub_bucket_count;
+                const std::size_t sub    = _index % sub_bucket_count;
+                const unsigned    shift  = static_cast<unsigned>(octave - 1);
+                return (uint64_t{sub_bucket_count + sub + 1}) << shift;
+            } // bucket_upper_bound
+
+            void record(const uint64_t _micros) noexcept {
+                buckets_[bucket_index(_micros)].fetch_add(1, std::memory_order_relaxed);
+                count_.fetch_add(1, std::memory_order_relaxed);
+                sum_.fetch_add(_micros, std::memory_order_relaxed);
+            } // record
+
+            void merge(const latency_histogram& _other) noexcept {
+                for(std::size_t b = 0; b < bucket_count; ++b) {
+                    if(const auto n = _other.bucket(b)) {
+                        buckets_[b].fetch_add(n, std::memory_order_relaxed);
+                    }
+                }
+                count_.fetch_add(_other.count(), std::memory_order_relaxed);
+                sum_.fetch_add(_other.sum(), std::memory_order_relaxed);
+            } // merge
+
+            uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+            uint64_t sum() const noexcept { return sum_.load(std::memory_order_relaxed); }
+            uint64_t bucket(const std::size_t _index) const noexcept {
+                return buckets_[_index].load(std::memory_order_relaxed);
+            }
+
+            private:
+            std::atomic<uint64_t> buckets_[bucket_count];
+            std::atomic<uint64_t> count_;
+            std::atomic<uint64_t> sum_;
+        }; // class latency_histogram
+
+        static_assert(latency_histogram::bucket_index(3) == 3);
+        static_assert(latency_histogram::bucket_index(4) == 4);
+        static_assert(latency_histogram::bucket_index(7) == 7);
+        static_assert(latency_histogram::bucket_index(8) == 8);
+        static_assert(latency_histogram::bucket_index(15) == 11);
+        static_assert(latency_histogram::bucket_upper_bound(7) == 8);
+        static_assert(latency_histogram::bucket_upper_bound(8) == 10);
+        static_assert(latency_histogram::bucket_upper_bound(11) == 16);
+    } // namespace publishing
+} // namespace irods
+
+#endif // LATENCY_HISTOGRAM_HPP
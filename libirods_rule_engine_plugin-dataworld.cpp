@@ -7,6 +7,16 @@
 #include "utilities.hpp"
 #include "plugin_specific_configuration.hpp"
 #include "configuration.hpp"
+#include "publishing_backend.hpp"
+#include "parallel.hpp"
+#include "host_pool.hpp"
+#include "fingerprint.hpp"
+#include "genquery_catalog.hpp"
+#include "replica_utilities.hpp"
+#include "mapped_file.hpp"
+#include "shard_planner.hpp"
+#include "pid_pool.hpp"
+#include "genquery_builder.hpp"
 #include <irods/dstream.hpp>
 #include <irods/rsModAVUMetadata.hpp>
 #include <irods/irods_hasher_factory.hpp>
@@ -19,9 +29,11 @@
 #include <cpr/response.h>
 #include <cpr/session.h>
 #include <cpr/cpr.h>
+#include <curl/curl.h>
 
 #include <boost/any.hpp>
 #include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/uuid/uuid.hpp>
@@ -37,49 +49,297 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <chrono>
+#include <ctime>
 
 namespace {
     struct configuration : irods::publishing::configuration {
-        std::vector<std::string> hosts_;
+        std::vector<std::string> hosts_{"https://api.data.world"};
+        std::string dataset_id{"irods::publishing::dataworld::dataset_id"};
+        std::string maximum_concurrent_requests{"8"};
+        std::string host_selection{"least_outstanding"};
+        std::string host_failure_threshold{"3"};
+        std::string host_retry_interval{"30"};
+        std::string shard_maximum_bytes{"0"};
+        std::string shard_maximum_objects{"0"};
+        std::string maximum_buffered_bytes{"268435456"};
+        std::string file_names{"object_name"};
+        std::string pid_service{};
+        std::string pid_batch_size{"1000"};
+        std::string pid_attribute{"irods::publishing::pid"};
         configuration(const std::string& _instance_name) :
             irods::publishing::configuration(_instance_name) {
             try {
                 auto cfg = irods::publishing::get_plugin_specific_configuration(_instance_name);
-                if(cfg.find("hosts") != cfg.end()) {
-                    std::vector<boost::any> host_list = boost::any_cast<std::vector<boost::any>>(cfg.at("hosts"));
-                    for( auto& i : host_list) {
-                        hosts_.push_back(boost::any_cast<std::string>(i));
+                auto capture_parameter = [&](const std::string& _param, std::string& _attr) {
+                    if (const auto iter = cfg.find(_param); iter != cfg.end()) {
+                        _attr = iter->get<std::string>();
+                    }
+                }; // capture_parameter
+
+                capture_parameter("dataset_id", dataset_id);
+                capture_parameter("maximum_concurrent_requests", maximum_concurrent_requests);
+                capture_parameter("host_selection", host_selection);
+                capture_parameter("host_failure_threshold", host_failure_threshold);
+                capture_parameter("host_retry_interval", host_retry_interval);
+                capture_parameter("shard_maximum_bytes", shard_maximum_bytes);
+                capture_parameter("shard_maximum_objects", shard_maximum_objects);
+                capture_parameter("maximum_buffered_bytes", maximum_buffered_bytes);
+                capture_parameter("file_names", file_names);
+                capture_parameter("pid_service", pid_service);
+                capture_parameter("pid_batch_size", pid_batch_size);
+                capture_parameter("pid_attribute", pid_attribute);
+                if("object_name" != file_names && "relative_path" != file_names) {
+                    THROW(
+                        SYS_INVALID_INPUT_PARAM,
+                        boost::format("[%s] file_names must be object_name or relative_path, not [%s]")
+                        % _instance_name
+                        % file_names);
+                }
+                if(const auto iter = cfg.find("hosts"); iter != cfg.end()) {
+                    hosts_ = iter->get<std::vector<std::string>>();
+                    if(hosts_.empty()) {
+                        THROW(
+                            SYS_INVALID_INPUT_PARAM,
+                            boost::format("[%s] hosts must name at least one host")
+                            % _instance_name);
                     }
                 }
             }
-            catch(const boost::bad_any_cast& _e) {
+            catch(const nlohmann::json::exception& _e) {
                 THROW(
-                    INVALID_ANY_CAST,
+                    SYS_LIBRARY_ERROR,
                     _e.what());
             }
         }// ctor
     }; // configuration
 
     std::unique_ptr<configuration> config;
+    std::unique_ptr<irods::publishing::host_pool> hosts;
+    std::unique_ptr<irods::publishing::pid_pool> pids;
     std::string object_publish_policy;
     std::string object_purge_policy;
     std::string collection_publish_policy;
     std::string collection_purge_policy;
+    std::string collection_reconcile_policy;
 
     std::string get_api_token_for_user(
         rsComm_t*         _comm,
         const std::string _user_name) {
 
-        std::string query_str{
-            boost::str(boost::format(
-            "SELECT META_USER_ATTR_VALUE where USER_NAME = '%s' and META_USER_ATTR_NAME = '%s'")
-            % _user_name
-            % config->api_token)};
-        irods::query qobj{_comm, query_str, 1};
-        return qobj.front()[0];
+        irods::publishing::genquery_catalog catalog{_comm};
+        const auto tokens = catalog.user_metadata(_user_name, config->api_token);
+        if(tokens.empty()) {
+            THROW(
+                CAT_NO_ROWS_FOUND,
+                boost::format("no [%s] annotation for user [%s]")
+                % config->api_token
+                % _user_name);
+        }
+
+        return tokens.front();
 
     } // get_api_token_for_user
 
+    std::size_t maximum_concurrent_requests() {
+        try {
+            return std::max(1, boost::lexical_cast<int>(config->maximum_concurrent_requests));
+        }
+        catch(const boost::bad_lexical_cast&) {
+            return 8;
+        }
+    } // maximum_concurrent_requests
+
+    // a size from the configuration, _default when it is not a number
+    uintmax_t configured_size(
+        const std::string& _value,
+        const uintmax_t    _default) {
+        try {
+            return static_cast<uintmax_t>(std::max<intmax_t>(0, boost::lexical_cast<intmax_t>(_value)));
+        }
+        catch(const boost::bad_lexical_cast&) {
+            return _default;
+        }
+    } // configured_size
+
+    uintmax_t shard_maximum_bytes() {
+        return configured_size(config->shard_maximum_bytes, 0);
+    } // shard_maximum_bytes
+
+    std::size_t shard_maximum_objects() {
+        return static_cast<std::size_t>(configured_size(config->shard_maximum_objects, 0));
+    } // shard_maximum_objects
+
+    uintmax_t maximum_buffered_bytes() {
+        return configured_size(config->maximum_buffered_bytes, 268435456);
+    } // maximum_buffered_bytes
+
+    // ask the pid service for _count new identifiers
+    std::vector<std::string> mint_pids(const std::size_t _count) {
+        const std::string url{config->pid_service + "/pids"};
+        auto r = cpr::Post(
+                     cpr::Url{url},
+                     cpr::Body{nlohmann::json{{"count", _count}}.dump()},
+                     cpr::Header{{"Content-Type", "application/json"}});
+        if(200 != r.status_code) {
+            THROW(
+                SYS_INTERNAL_ERR,
+                boost::format("pid service [%s] answered [%d] [%s]")
+                % url
+                % static_cast<int>(r.status_code)
+                % r.text);
+        }
+
+        try {
+            return nlohmann::json::parse(r.text).at("pids").get<std::vector<std::string>>();
+        }
+        catch(const nlohmann::json::exception& _e) {
+            THROW(
+                SYS_INTERNAL_ERR,
+                boost::format("invalid response from pid service [%s] [%s]")
+                % url
+                % _e.what());
+        }
+    } // mint_pids
+
+    std::unique_ptr<irods::publishing::pid_pool> make_pid_pool(const std::string& _instance_name) {
+        if(config->pid_service.empty()) {
+            return {};
+        }
+
+        return std::make_unique<irods::publishing::pid_pool>(
+                   _instance_name,
+                   mint_pids,
+                   static_cast<std::size_t>(configured_size(config->pid_batch_size, 1000)));
+    } // make_pid_pool
+
+    std::unique_ptr<irods::publishing::host_pool> make_host_pool() {
+        try {
+            return std::make_unique<irods::publishing::host_pool>(
+                       config->hosts_,
+                       irods::publishing::host_pool::to_selection(config->host_selection),
+                       boost::lexical_cast<unsigned>(config->host_failure_threshold),
+                       std::chrono::seconds{boost::lexical_cast<int>(config->host_retry_interval)});
+        }
+        catch(const boost::bad_lexical_cast&) {
+            THROW(
+                SYS_INVALID_INPUT_PARAM,
+                boost::format("invalid host_failure_threshold [%s] or host_retry_interval [%s]")
+                % config->host_failure_threshold
+                % config->host_retry_interval);
+        }
+        catch(const std::invalid_argument& _e) {
+            THROW(
+                SYS_INVALID_INPUT_PARAM,
+                _e.what());
+        }
+    } // make_host_pool
+
+    // true when the request failed before a connection was made, so the
+    // service cannot have acted on it
+    bool never_sent(const cpr::Response& _r) {
+        return cpr::ErrorCode::COULDNT_RESOLVE_HOST == _r.error.code ||
+               cpr::ErrorCode::COULDNT_CONNECT == _r.error.code;
+    } // never_sent
+
+    // issue a request for the api path _path against a host from the pool.
+    // transport failures are retried on another host, but a request which
+    // is not idempotent only when it never left this server, as one which
+    // timed out may still have been carried out.  server errors count
+    // against the host's health
+    template<typename Request>
+    cpr::Response send_request(
+        const std::string& _path,
+        Request            _request,
+        const bool         _idempotent = true) {
+        cpr::Response r;
+        for(std::size_t attempt = 0; attempt < hosts->size(); ++attempt) {
+            auto host = hosts->acquire();
+            r = _request(cpr::Url{host.url() + _path});
+            if(0 == r.status_code || r.status_code >= 500) {
+                host.failed();
+                rodsLog(
+                    LOG_NOTICE,
+                    "request to [%s] failed with [%d] [%s]",
+                    host.url().c_str(),
+                    static_cast<int>(r.status_code),
+                    r.error.message.c_str());
+                if(0 == r.status_code && (_idempotent || never_sent(r))) {
+                    continue;
+                }
+                return r;
+            }
+
+            host.succeeded();
+            return r;
+        }
+
+        return r;
+    } // send_request
+
+    std::vector<std::string> get_dataset_ids(
+        rsComm_t*          _comm,
+        const std::string& _path,
+        const bool         _is_collection) {
+        std::string query_str;
+        if(_is_collection) {
+            query_str = boost::str(boost::format(
+                "SELECT META_COLL_ATTR_VALUE WHERE META_COLL_ATTR_NAME = '%s' and COLL_NAME = '%s'")
+                % irods::publishing::escape_genquery_literal(config->dataset_id)
+                % irods::publishing::escape_genquery_literal(_path));
+        }
+        else {
+            boost::filesystem::path p{_path};
+            query_str = boost::str(boost::format(
+                "SELECT META_DATA_ATTR_VALUE WHERE META_DATA_ATTR_NAME = '%s' and DATA_NAME = '%s' AND COLL_NAME = '%s'")
+                % irods::publishing::escape_genquery_literal(config->dataset_id)
+                % irods::publishing::escape_genquery_literal(p.filename().string())
+                % irods::publishing::escape_genquery_literal(p.parent_path().string()));
+        }
+
+        std::vector<std::string> ids;
+        for(const auto& row : irods::query{_comm, query_str}) {
+            ids.push_back(row[0]);
+        }
+
+        return ids;
+    } // get_dataset_ids
+
+    void modify_dataset_id_metadata(
+        rsComm_t*          _comm,
+        const std::string& _operation,
+        const std::string& _path,
+        const bool         _is_collection,
+        const std::string& _data_set_id) {
+        std::string type{_is_collection ? "-C" : "-d"};
+        modAVUMetadataInp_t inp{};
+        inp.arg0 = const_cast<char*>(_operation.c_str());
+        inp.arg1 = const_cast<char*>(type.c_str());
+        inp.arg2 = const_cast<char*>(_path.c_str());
+        inp.arg3 = const_cast<char*>(config->dataset_id.c_str());
+        inp.arg4 = const_cast<char*>(_data_set_id.c_str());
+        inp.arg5 = "";
+        const auto status = rsModAVUMetadata(_comm, &inp);
+        if(status < 0) {
+            THROW(
+                status,
+                boost::format("failed to %s dataset id [%s] on [%s]")
+                % _operation
+                % _data_set_id
+                % _path);
+        }
+    } // modify_dataset_id_metadata
+
     void apply_persistent_identifier_policy(
         ruleExecInfo_t*    _rei,
         const std::string& _object_path,
@@ -122,7 +382,8 @@ namespace {
     std::string create_dataset(
         const std::string& _object_path,
         const std::string& _user_name,
-        const std::string& _api_token) {
+        const std::string& _api_token,
+        const std::string& _title_suffix = {}) {
         namespace fs   = irods::experimental::filesystem;
         namespace fsvr = irods::experimental::filesystem::server;
         using json = nlohmann::json;
@@ -132,31 +393,34 @@ namespace {
 
         const std::string auth_string{"Bearer " + _api_token};
 
-        const std::string data_set_title{data_name.string()};
+        const std::string data_set_title{data_name.string() + _title_suffix};
         const std::string data_set_visibility{"OPEN"}; // config param :: OPEN vs PRIVATE
 
         std::string data_set_id{};
 
-        const std::string url{
-            boost::str(boost::format("https://api.data.world/v0/datasets/%s")
+        const std::string path{
+            boost::str(boost::format("/v0/datasets/%s")
             % _user_name)};
 
         nlohmann::json payload;
         payload["title"] = data_set_title;
         payload["visibility"] = data_set_visibility;
 
-        auto r = cpr::Post(
-                     cpr::Url{url},
-                     cpr::Body{payload.dump()},
-                     cpr::Header{
-                         {"Content-Type", "application/json"},
-                         {"Authorization", auth_string}});
-        auto response = json::parse(r.text);
+        // each create makes another dataset
+        auto r = send_request(path, [&](const cpr::Url& _url) {
+                     return cpr::Post(
+                         _url,
+                         cpr::Body{payload.dump()},
+                         cpr::Header{
+                             {"Content-Type", "application/json"},
+                             {"Authorization", auth_string}});
+                 }, false);
         if(200 != r.status_code) {
             THROW(
                 SYS_INTERNAL_ERR,
                 r.text);
         }
+        auto response = json::parse(r.text);
 
         rodsLog(
             config->log_level,
@@ -174,28 +438,136 @@ namespace {
 
     } // create_dataset
 
+    // the name under which an object is stored in the dataset published for
+    // _root.  by default only the object name is used, so objects of the same
+    // name in different sub-collections share a file.  with file_names set to
+    // relative_path the path beneath _root is kept, '%' written as %25 and '/'
+    // as %2F so that no two paths share a name
+    std::string remote_file_name(
+        const std::string& _root,
+        const std::string& _object_path) {
+        namespace fs = irods::experimental::filesystem;
+        const bool beneath = _object_path.size() > _root.size() + 1 &&
+                             '/' == _object_path[_root.size()] &&
+                             0 == _object_path.compare(0, _root.size(), _root);
+        if("relative_path" != config->file_names || !beneath) {
+            return fs::path{_object_path}.object_name().string();
+        }
+
+        std::string name;
+        for(const auto c : _object_path.substr(_root.size() + 1)) {
+            switch(c) {
+                case '%': name += "%25"; break;
+                case '/': name += "%2F"; break;
+                default:  name += c;     break;
+            }
+        }
+        return name;
+    } // remote_file_name
+
+    // _segment escaped for use as one segment of a url path
+    std::string escape_path_segment(const std::string& _segment) {
+        static const char* const hex = "0123456789ABCDEF";
+        std::string escaped;
+        escaped.reserve(_segment.size());
+        for(const auto c : _segment) {
+            const auto u = static_cast<unsigned char>(c);
+            if(std::isalnum(u) || '-' == c || '.' == c || '_' == c || '~' == c) {
+                escaped += c;
+            }
+            else {
+                escaped += '%';
+                escaped += hex[u >> 4];
+                escaped += hex[u & 0xf];
+            }
+        }
+        return escaped;
+    } // escape_path_segment
+
+    // PUT _size bytes at _data.  cpr copies a request body into a string of
+    // its own, so curl is driven directly and reads the body from the
+    // caller's memory, which may be a mapped vault file
+    cpr::Response put_without_copy(
+        const cpr::Url&                 _url,
+        const std::vector<std::string>& _headers,
+        const char*                     _data,
+        const uintmax_t                 _size) {
+        struct cursor {
+            const char* data;
+            uintmax_t   remaining;
+        } body{_data, _size};
+
+        const auto read_body = [](char* _buffer, size_t _size, size_t _count, void* _body) -> size_t {
+            auto* b = static_cast<cursor*>(_body);
+            const auto n = static_cast<size_t>(std::min<uintmax_t>(b->remaining, _size * _count));
+            std::memcpy(_buffer, b->data, n);
+            b->data      += n;
+            b->remaining -= n;
+            return n;
+        };
+
+        const auto write_response = [](char* _data, size_t _size, size_t _count, void* _text) -> size_t {
+            static_cast<std::string*>(_text)->append(_data, _size * _count);
+            return _size * _count;
+        };
+
+        std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> curl{curl_easy_init(), curl_easy_cleanup};
+        curl_slist* header_list{};
+        for(const auto& h : _headers) {
+            header_list = curl_slist_append(header_list, h.c_str());
+        }
+        std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)> headers{header_list, curl_slist_free_all};
+
+        cpr::Response r;
+        r.url = _url;
+        if(!curl) {
+            r.error.message = "curl_easy_init failed";
+            return r;
+        }
+
+        curl_easy_setopt(curl.get(), CURLOPT_URL, _url.c_str());
+        curl_easy_setopt(curl.get(), CURLOPT_UPLOAD, 1L);
+        curl_easy_setopt(curl.get(), CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(_size));
+        curl_easy_setopt(curl.get(), CURLOPT_READFUNCTION, +read_body);
+        curl_easy_setopt(curl.get(), CURLOPT_READDATA, &body);
+        curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, +write_response);
+        curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &r.text);
+        curl_easy_setopt(curl.get(), CURLOPT_HTTPHEADER, headers.get());
+        curl_easy_setopt(curl.get(), CURLOPT_NOSIGNAL, 1L);
+
+        const auto code = curl_easy_perform(curl.get());
+        if(CURLE_OK != code) {
+            // reported as a connection failure so the request moves to another host
+            r.error.message = curl_easy_strerror(code);
+            return r;
+        }
+
+        long status{};
+        curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, &status);
+        r.status_code = status;
+        return r;
+    } // put_without_copy
+
     void upload_file(
         const std::string& _user_name,
         const std::string& _data_set_id,
         const std::string& _api_token,
-        const std::string& _object_path,
+        const std::string& _file_name,
         const char*        _data,
         const uintmax_t    _size) {
-        const std::string auth_string{"Bearer " + _api_token};
-        namespace fs = irods::experimental::filesystem;
-        fs::path object_path{_object_path};
-        auto data_name{object_path.object_name()};
-        const std::string url{
-            boost::str(boost::format("https://api.data.world/v0/uploads/%s/%s/files/%s")
+        const std::vector<std::string> headers{
+            "Authorization: Bearer " + _api_token,
+            "Content-Type: application/octet-stream",
+            // the service answers immediately, skip the round trip of asking
+            "Expect:"};
+        const std::string path{
+            boost::str(boost::format("/v0/uploads/%s/%s/files/%s")
             % _user_name
             % _data_set_id
-            % data_name.string())};
-        auto r = cpr::Put(
-                     cpr::Url{url},
-                     cpr::Body{_data, _size},
-                     cpr::Header{
-                         {"Authorization", auth_string},
-                         {"Content-Type", "application/octet-stream"}});
+            % escape_path_segment(_file_name))};
+        auto r = send_request(path, [&](const cpr::Url& _url) {
+                     return put_without_copy(_url, headers, _data, _size);
+                 });
         if(200 != r.status_code) {
             THROW(
                 SYS_INTERNAL_ERR,
@@ -211,42 +583,462 @@ namespace {
 
     } // upload_file
 
-    void invoke_publish_object_policy(
-        ruleExecInfo_t*    _rei,
-        const std::string& _object_path,
-        const std::string& _user_name,
-        const std::string& _publish_type) {
-        namespace fsvr = irods::experimental::filesystem::server;
+    // the contents of an object ready to upload, a read only mapping of its
+    // replica in a local vault or a buffer the replica was streamed into
+    struct object_contents {
+        std::optional<irods::publishing::mapped_file> mapped;
+        std::vector<char>                             buffer;
+
+        const char* data() const { return mapped ? mapped->data() : buffer.data(); }
+        uintmax_t size() const { return mapped ? mapped->size() : buffer.size(); }
+    }; // struct object_contents
+
+    std::shared_ptr<object_contents> read_object(
+        rsComm_t&          _comm,
+        const std::string& _object_path) {
+        namespace io = irods::experimental::io;
+
+        // read from the replica which is quickest to reach rather than
+        // whichever the server resolves to
+        const auto source = irods::publishing::select_replica_for_read(
+                                _comm,
+                                _object_path,
+                                config->replica_selection);
+        if(!source) {
+            THROW(
+                SYS_NO_GOOD_REPLICA,
+                boost::format("no good replica to publish [%s]")
+                % _object_path);
+        }
+
+        auto contents = std::make_shared<object_contents>();
+        if(const auto vault_path = irods::publishing::local_vault_path(*source)) {
+            try {
+                contents->mapped.emplace(*vault_path);
+                return contents;
+            }
+            catch(const irods::exception& _e) {
+                rodsLog(
+                    LOG_NOTICE,
+                    "reading [%s] through irods [%s]",
+                    _object_path.c_str(),
+                    _e.client_display_what());
+            }
+        }
+
+        io::server::basic_transport<char> xport(_comm);
+        io::idstream ds{xport, _object_path, io::replica_number{source->number}};
+        if(!ds.is_open()) {
+            THROW(
+                SYS_INTERNAL_ERR,
+                boost::format("failed to open replica [%d] of [%s]")
+                % source->number
+                % _object_path);
+        }
+
+        contents->buffer.resize(source->size);
+        ds.read(contents->buffer.data(), contents->buffer.size());
+        if(static_cast<uintmax_t>(ds.gcount()) != source->size) {
+            THROW(
+                SYS_INTERNAL_ERR,
+                boost::format("read [%lld] of [%ju] bytes of [%s]")
+                % static_cast<long long>(ds.gcount())
+                % source->size
+                % _object_path);
+        }
+
+        return contents;
+    } // read_object
+
+    void publish_file(
+        rsComm_t&                             _comm,
+        const std::string&                    _user_name,
+        const std::string&                    _data_set_id,
+        const std::string&                    _api_token,
+        const std::string&                    _object_path,
+        const std::string&                    _file_name,
+        irods::publishing::pipeline_metrics* _metrics) {
+        using irods::publishing::pipeline_metrics;
+
+        const auto read_start = pipeline_metrics::now();
+        const auto contents   = read_object(_comm, _object_path);
+
+        const auto upload_start = pipeline_metrics::now();
+        upload_file(
+            _user_name,
+            _data_set_id,
+            _api_token,
+            _file_name,
+            contents->data(),
+            contents->size());
+
+        if(_metrics) {
+            _metrics->object_read(contents->size(), upload_start - read_start);
+            _metrics->object_uploaded(contents->size(), pipeline_metrics::now() - upload_start);
+        }
+    } // publish_file
+
+    struct pending_upload {
+        std::string object_path;
+        std::string file_name;
+        std::string data_set_id;
+        uintmax_t   size{};
+        std::string checksum; // as the catalog has it, may be empty
+    }; // struct pending_upload
+
+    // what is recorded for each object published to data.world
+    void record_upload(
+        irods::publishing::publication_results* _results,
+        const pending_upload&                    _upload) {
+        if(!_results) {
+            return;
+        }
+
+        const auto& path = _upload.object_path;
+        _results->record(path, false, _results->attribute("dataworld::dataset_id"), _upload.data_set_id);
+        _results->record(path, false, _results->attribute("dataworld::file"), _upload.file_name);
+        _results->record(path, false, _results->attribute("published_at"), std::to_string(std::time(nullptr)));
+        if(!_upload.checksum.empty()) {
+            _results->record(path, false, _results->attribute("checksum"), _upload.checksum);
+        }
+    } // record_upload
+
+    struct upload_outcome {
+        std::vector<bool> published; // by position in the uploads
+        std::size_t       failed{};
+    }; // struct upload_outcome
+
+    // publish each object to its dataset.  objects are read on this thread,
+    // which owns the connection, and uploaded by up to
+    // maximum_concurrent_requests workers while the next is read.  reads wait
+    // while maximum_buffered_bytes are held by uploads still in flight.  a
+    // failed object is logged and skipped, objects not reached before a
+    // cancellation are neither published nor failed
+    upload_outcome upload_objects(
+        rsComm_t&                                    _comm,
+        const std::string&                           _user_name,
+        const std::string&                           _api_token,
+        const std::vector<pending_upload>&           _uploads,
+        irods::publishing::pipeline_metrics*        _metrics,
+        const irods::publishing::cancellation_check& _cancelled,
+        irods::publishing::publication_results*     _results) {
+        using irods::publishing::pipeline_metrics;
+
+        const auto concurrency  = maximum_concurrent_requests();
+        const auto buffer_limit = maximum_buffered_bytes();
+
+        upload_outcome          outcome;
+        std::mutex              mutex;
+        std::condition_variable released;
+        uintmax_t               buffered{};
+        outcome.published.resize(_uploads.size());
+
+        irods::publishing::worker_pool pool{concurrency, concurrency};
+        for(std::size_t i = 0; i < _uploads.size(); ++i) {
+            if(irods::publishing::cancellation_requested(_cancelled)) {
+                break;
+            }
+
+            // results are written on this thread, which owns the connection
+            if(_results) {
+                _results->flush_if_full(_comm);
+            }
+
+            const auto& u = _uploads[i];
+            {
+                // an object larger than the limit is read once nothing else is held
+                std::unique_lock<std::mutex> lock{mutex};
+                released.wait(lock, [&] { return 0 == buffered || buffered + u.size <= buffer_limit; });
+                buffered += u.size;
+            }
+
+            const auto finish = [&, i, size = u.size](const bool _published) {
+                {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    buffered -= size;
+                    outcome.published[i] = _published;
+                    outcome.failed += _published ? 0 : 1;
+                }
+                if(!_published && _metrics) {
+                    _metrics->object_failed();
+                }
+                released.notify_one();
+            };
+
+            std::shared_ptr<object_contents> contents;
+            const auto read_start = pipeline_metrics::now();
+            try {
+                contents = read_object(_comm, u.object_path);
+            }
+            catch(const irods::exception& _e) {
+                rodsLog(
+                    LOG_ERROR,
+                    "failed to publish object [%s] [%s]",
+                    u.object_path.c_str(),
+                    _e.client_display_what());
+                finish(false);
+                continue;
+            }
+
+            if(_metrics) {
+                _metrics->object_read(contents->size(), pipeline_metrics::now() - read_start);
+            }
+
+            pool.submit([&, contents, finish] {
+                const auto upload_start = pipeline_metrics::now();
+                try {
+                    upload_file(
+                        _user_name,
+                        u.data_set_id,
+                        _api_token,
+                        u.file_name,
+                        contents->data(),
+                        contents->size());
+                    if(_metrics) {
+                        _metrics->object_uploaded(contents->size(), pipeline_metrics::now() - upload_start);
+                    }
+                }
+                catch(const std::exception& _e) {
+                    // nothing escapes a task, the pool would discard those
+                    // queued along with the bytes they hold
+                    rodsLog(
+                        LOG_ERROR,
+                        "failed to publish object [%s] [%s]",
+                        u.object_path.c_str(),
+                        _e.what());
+                    finish(false);
+                    return;
+                }
+                record_upload(_results, u);
+                finish(true);
+            });
+        }
+
+        pool.wait();
+        return outcome;
+    } // upload_objects
+
+    void delete_remote(
+        const std::string& _path,
+        const std::string& _api_token) {
+        auto r = send_request(_path, [&](const cpr::Url& _url) {
+                     return cpr::Delete(
+                         _url,
+                         cpr::Header{
+                             {"Authorization", "Bearer " + _api_token}});
+                 });
+        // a missing dataset or file has already been purged
+        if(200 != r.status_code && 404 != r.status_code) {
+            THROW(
+                SYS_INTERNAL_ERR,
+                r.text);
+        }
+
+        rodsLog(
+            config->log_level,
+            "return code [%d] status [%s] url [%s]",
+            r.status_code,
+            r.text.c_str(),
+            r.url.c_str());
+    } // delete_remote
+
+    void delete_datasets(
+        const std::string&              _user_name,
+        const std::string&              _api_token,
+        const std::vector<std::string>& _data_set_ids) {
+        irods::publishing::parallel_for_each(
+            _data_set_ids,
+            maximum_concurrent_requests(),
+            [&](const std::string& _id) {
+                delete_remote(
+                    boost::str(boost::format("/v0/datasets/%s/%s")
+                    % _user_name
+                    % _id),
+                    _api_token);
+            });
+    } // delete_datasets
+
+    void delete_files(
+        const std::string&              _user_name,
+        const std::string&              _data_set_id,
+        const std::string&              _api_token,
+        const std::vector<std::string>& _file_names) {
+        irods::publishing::parallel_for_each(
+            _file_names,
+            maximum_concurrent_requests(),
+            [&](const std::string& _name) {
+                delete_remote(
+                    boost::str(boost::format("/v0/datasets/%s/%s/files/%s")
+                    % _user_name
+                    % _data_set_id
+                    % escape_path_segment(_name)),
+                    _api_token);
+            });
+    } // delete_files
+
+    struct catalog_object {
+        std::string path;
+        uintmax_t   size{};
+        std::string checksum;
+    }; // struct catalog_object
+
+    // every object beneath _collection_name, once regardless of the number
+    // of replicas
+    std::vector<catalog_object> list_collection_objects(
+        rsComm_t*          _comm,
+        const std::string& _collection_name) {
+        std::string query_str{
+            boost::str(boost::format(
+            "SELECT COLL_NAME, DATA_NAME, DATA_SIZE, DATA_CHECKSUM WHERE COLL_NAME = '%s' || like '%s/%%'")
+            % irods::publishing::escape_genquery_literal(_collection_name)
+            % irods::publishing::escape_genquery_literal(_collection_name))};
+
+        std::vector<catalog_object> objects;
+        std::set<std::string> seen;
+        for(const auto& row : irods::query{_comm, query_str}) {
+            std::string object_path{row[0] + "/" + row[1]};
+            if(!seen.insert(object_path).second) {
+                continue;
+            }
+
+            objects.push_back({std::move(object_path), boost::lexical_cast<uintmax_t>(row[2]), row[3]});
+        }
+
+        return objects;
+    } // list_collection_objects
+
+    // give _root, and each of _object_paths beneath a collection, a persistent
+    // identifier recorded in the pid_attribute annotation unless it has one.
+    // identifiers come from the pool in a single take once the uploads are
+    // done, so the service is never waited on per object, and are written
+    // with the other results of the publication when it records them.  a
+    // failure here is logged, the publication itself stands
+    void assign_persistent_identifiers(
+        rsComm_t&                                _comm,
+        const std::string&                       _root,
+        const bool                               _is_collection,
+        const std::vector<std::string>&          _object_paths,
+        irods::publishing::publication_results* _results) {
+        namespace fs = irods::experimental::filesystem;
+
+        if(!pids) {
+            return;
+        }
 
         try {
-            std::string pid{"persistent_identifier"};
-            /*apply_persistent_identifier_policy(
-                _rei,
-                _object_path,
-                _source_resource,
-                &pid);*/
+            std::set<std::string> assigned;
+            if(_is_collection) {
+                const auto collection_query = boost::str(boost::format(
+                    "SELECT COLL_NAME WHERE META_COLL_ATTR_NAME = '%s' AND COLL_NAME = '%s'")
+                    % irods::publishing::escape_genquery_literal(config->pid_attribute)
+                    % irods::publishing::escape_genquery_literal(_root));
+                for(const auto& row : irods::query{&_comm, collection_query}) {
+                    assigned.insert(row[0]);
+                }
 
+                if(!_object_paths.empty()) {
+                    const auto object_query = boost::str(boost::format(
+                        "SELECT COLL_NAME, DATA_NAME WHERE META_DATA_ATTR_NAME = '%s' AND COLL_NAME = '%s' || like '%s/%%'")
+                        % irods::publishing::escape_genquery_literal(config->pid_attribute)
+                        % irods::publishing::escape_genquery_literal(_root)
+                        % irods::publishing::escape_genquery_literal(_root));
+                    for(const auto& row : irods::query{&_comm, object_query}) {
+                        assigned.insert(row[0] + "/" + row[1]);
+                    }
+                }
+            }
+            else {
+                const fs::path p{_root};
+                const auto object_query = boost::str(boost::format(
+                    "SELECT COLL_NAME, DATA_NAME WHERE META_DATA_ATTR_NAME = '%s' AND COLL_NAME = '%s' AND DATA_NAME = '%s'")
+                    % irods::publishing::escape_genquery_literal(config->pid_attribute)
+                    % irods::publishing::escape_genquery_literal(p.parent_path().string())
+                    % irods::publishing::escape_genquery_literal(p.object_name().string()));
+                for(const auto& row : irods::query{&_comm, object_query}) {
+                    assigned.insert(row[0] + "/" + row[1]);
+                }
+            }
+
+            // path and whether it is a collection
+            std::vector<std::pair<std::string, bool>> missing;
+            if(!assigned.count(_root)) {
+                missing.emplace_back(_root, _is_collection);
+            }
+            for(const auto& o : _object_paths) {
+                if(!assigned.count(o)) {
+                    missing.emplace_back(o, false);
+                }
+            }
+
+            // when results are not recorded the identifiers are written as
+            // one batch of their own, looked up a collection at a time
+            std::unique_ptr<irods::publishing::publication_results> own_results;
+            if(!_results) {
+                own_results = std::make_unique<irods::publishing::publication_results>("", missing.size());
+            }
+            auto* results = _results ? _results : own_results.get();
+
+            const auto identifiers = pids->take(missing.size());
+            for(std::size_t i = 0; i < missing.size(); ++i) {
+                results->record(missing[i].first, missing[i].second, config->pid_attribute, identifiers[i]);
+            }
+
+            if(own_results) {
+                own_results->flush(_comm);
+            }
+
+            rodsLog(
+                config->log_level,
+                "assigned [%zu] persistent identifiers beneath [%s]",
+                missing.size(),
+                _root.c_str());
+        }
+        catch(const irods::exception& _e) {
+            rodsLog(
+                LOG_ERROR,
+                "failed to assign persistent identifiers beneath [%s] [%s]",
+                _root.c_str(),
+                _e.client_display_what());
+        }
+    } // assign_persistent_identifiers
+
+    void invoke_publish_object_policy(
+        ruleExecInfo_t*                              _rei,
+        const std::string&                           _object_path,
+        const std::string&                           _user_name,
+        const std::string&                           _publish_type,
+        irods::publishing::pipeline_metrics*        _metrics = nullptr,
+        const irods::publishing::cancellation_check& _cancelled = {},
+        irods::publishing::publication_results*     _results = nullptr) {
+        namespace fs = irods::experimental::filesystem;
+
+        try {
             const auto api_token{get_api_token_for_user(_rei->rsComm, _user_name)};
             auto data_set_id = create_dataset(
                                    _object_path,
                                    _user_name,
                                    api_token);
+            if(_metrics) {
+                _metrics->dataset_created();
+            }
+            modify_dataset_id_metadata(_rei->rsComm, "add", _object_path, false, data_set_id);
 
-            // read the data out of irods into a buffer
-            auto object_size = fsvr::data_object_size(*_rei->rsComm, _object_path);
-            irods::experimental::io::server::basic_transport<char> xport(*_rei->rsComm);
-            irods::experimental::io::idstream ds{xport, _object_path};
-            const uintmax_t read_size{object_size};
-            char read_buff[read_size];
-            ds.read(read_buff, read_size);
+            if(irods::publishing::cancellation_requested(_cancelled)) {
+                return;
+            }
 
-            upload_file(
+            const auto root = fs::path{_object_path}.parent_path().string();
+            publish_file(
+                *_rei->rsComm,
                 _user_name,
                 data_set_id,
                 api_token,
                 _object_path,
-                read_buff,
-                read_size);
+                remote_file_name(root, _object_path),
+                _metrics);
+
+            record_upload(_results, {_object_path, remote_file_name(root, _object_path), data_set_id});
+            assign_persistent_identifiers(*_rei->rsComm, _object_path, false, {}, _results);
         }
         catch(const std::runtime_error& _e) {
             rodsLog(
@@ -269,50 +1061,506 @@ namespace {
     } // invoke_publish_object_policy
 
     void invoke_publish_collection_policy(
-        ruleExecInfo_t*    _rei,
-        const std::string& _collection_name,
+        ruleExecInfo_t*                              _rei,
+        const std::string&                           _collection_name,
+        const std::string&                           _user_name,
+        const std::string&                           _publish_type,
+        irods::publishing::pipeline_metrics*        _metrics = nullptr,
+        const irods::publishing::cancellation_check& _cancelled = {},
+        irods::publishing::publication_results*     _results = nullptr) {
+        try {
+            rsComm_t& comm = *_rei->rsComm;
+            const auto api_token{get_api_token_for_user(&comm, _user_name)};
+
+            const auto objects = list_collection_objects(&comm, _collection_name);
+            std::vector<uintmax_t> sizes;
+            sizes.reserve(objects.size());
+            for(const auto& o : objects) {
+                sizes.push_back(o.size);
+            }
+
+            // an empty collection is still published, as a single empty dataset
+            auto shards = irods::publishing::plan_shards(
+                              sizes,
+                              shard_maximum_bytes(),
+                              shard_maximum_objects());
+            if(shards.empty()) {
+                shards.resize(1);
+            }
+
+            // creating the datasets touches only the service
+            std::vector<std::size_t> indices(shards.size());
+            std::iota(indices.begin(), indices.end(), std::size_t{0});
+            std::vector<std::string> data_set_ids(shards.size());
+            const auto annotate = [&] {
+                // the dataset id annotations are the index of the shards
+                for(const auto& id : data_set_ids) {
+                    if(!id.empty()) {
+                        modify_dataset_id_metadata(&comm, "add", _collection_name, true, id);
+                    }
+                }
+            };
+
+            try {
+                irods::publishing::parallel_for_each(
+                    indices,
+                    maximum_concurrent_requests(),
+                    [&](const std::size_t _i) {
+                        const auto suffix = shards.size() > 1 ?
+                                            boost::str(boost::format(" (shard %zu of %zu)") % (_i + 1) % shards.size()) :
+                                            std::string{};
+                        data_set_ids[_i] = create_dataset(
+                                               _collection_name,
+                                               _user_name,
+                                               api_token,
+                                               suffix);
+                    });
+            }
+            catch(...) {
+                // record the datasets which were created so a purge removes them
+                annotate();
+                throw;
+            }
+
+            if(_metrics) {
+                _metrics->dataset_created();
+            }
+
+            annotate();
+
+            rodsLog(
+                config->log_level,
+                "publishing [%s] objects [%zu] as [%zu] datasets",
+                _collection_name.c_str(),
+                objects.size(),
+                shards.size());
+
+            // interleave the shards so every dataset is uploaded to at once
+            std::vector<pending_upload> uploads;
+            uploads.reserve(objects.size());
+            for(std::size_t position = 0; uploads.size() < objects.size(); ++position) {
+                for(std::size_t s = 0; s < shards.size(); ++s) {
+                    if(position >= shards[s].items.size()) {
+                        continue;
+                    }
+
+                    const auto& o = objects[shards[s].items[position]];
+                    uploads.push_back({
+                        o.path,
+                        remote_file_name(_collection_name, o.path),
+                        data_set_ids[s],
+                        o.size,
+                        o.checksum});
+                }
+            }
+
+            std::set<std::string> names;
+            std::size_t collisions{};
+            for(const auto& u : uploads) {
+                collisions += names.insert(u.file_name).second ? 0 : 1;
+            }
+            if(collisions > 0) {
+                rodsLog(
+                    LOG_WARNING,
+                    "[%zu] objects of [%s] share a name with another object and overwrite it, "
+                    "set file_names to relative_path to keep them apart",
+                    collisions,
+                    _collection_name.c_str());
+            }
+
+            const auto outcome = upload_objects(comm, _user_name, api_token, uploads, _metrics, _cancelled, _results);
+            if(irods::publishing::cancellation_requested(_cancelled)) {
+                rodsLog(
+                    config->log_level,
+                    "publication of [%s] cancelled",
+                    _collection_name.c_str());
+                return;
+            }
+
+            std::vector<std::string> published;
+            for(std::size_t i = 0; i < uploads.size(); ++i) {
+                if(outcome.published[i]) {
+                    published.push_back(uploads[i].object_path);
+                }
+            }
+            if(_results && 0 == outcome.failed) {
+                _results->record(_collection_name, true, _results->attribute("published_at"), std::to_string(std::time(nullptr)));
+            }
+            assign_persistent_identifiers(comm, _collection_name, true, published, _results);
+
+            // as for a reconciliation, what was published keeps its
+            // identifiers and the job fails
+            if(outcome.failed > 0) {
+                THROW(
+                    SYS_INTERNAL_ERR,
+                    boost::format("[%zu] objects of [%s] failed to publish")
+                    % outcome.failed
+                    % _collection_name);
+            }
+        }
+        catch(const std::runtime_error& _e) {
+            rodsLog(
+                LOG_ERROR,
+                "Exception [%s]",
+                _e.what());
+            THROW(
+                SYS_INTERNAL_ERR,
+                _e.what());
+        }
+        catch(const std::exception& _e) {
+            rodsLog(
+                LOG_ERROR,
+                "Exception [%s]",
+                _e.what());
+            THROW(
+                SYS_INTERNAL_ERR,
+                _e.what());
+        }
+    } // invoke_publish_collection_policy
+
+    // collects name and size of each entry of the "files" array of a dataset
+    // description without building a document for the whole response
+    class remote_file_listing {
+        public:
+        using json = nlohmann::json;
+
+        std::map<std::string, uintmax_t> files;
+
+        bool null() { return true; }
+        bool boolean(bool) { return true; }
+        bool number_integer(json::number_integer_t _v) {
+            capture_size(static_cast<uintmax_t>(std::max<json::number_integer_t>(0, _v)));
+            return true;
+        }
+        bool number_unsigned(json::number_unsigned_t _v) {
+            capture_size(_v);
+            return true;
+        }
+        bool number_float(json::number_float_t, const json::string_t&) { return true; }
+        bool string(json::string_t& _v) {
+            if(in_file() && "name" == key_) {
+                name_ = _v;
+            }
+            return true;
+        }
+        template<typename B>
+        bool binary(B&) { return true; }
+        bool key(json::string_t& _k) {
+            key_ = _k;
+            return true;
+        }
+        bool start_object(std::size_t) {
+            ++depth_;
+            if(in_file()) {
+                name_.clear();
+                size_ = 0;
+            }
+            return true;
+        }
+        bool end_object() {
+            if(in_file() && !name_.empty()) {
+                files[name_] = size_;
+            }
+            --depth_;
+            return true;
+        }
+        bool start_array(std::size_t) {
+            ++depth_;
+            if(2 == depth_ && "files" == key_) {
+                in_files_ = true;
+            }
+            return true;
+        }
+        bool end_array() {
+            if(2 == depth_) {
+                in_files_ = false;
+            }
+            --depth_;
+            return true;
+        }
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& _e) {
+            THROW(
+                SYS_INTERNAL_ERR,
+                boost::format("failed to parse dataset description [%s]")
+                % _e.what());
+        }
+
+        private:
+        bool in_file() const { return in_files_ && 3 == depth_; }
+        void capture_size(const uintmax_t _size) {
+            if(in_file() && "sizeInBytes" == key_) {
+                size_ = _size;
+            }
+        }
+
+        int         depth_{};
+        bool        in_files_{};
+        std::string key_;
+        std::string name_;
+        uintmax_t   size_{};
+    }; // class remote_file_listing
+
+    std::map<std::string, uintmax_t> list_remote_files(
         const std::string& _user_name,
-        const std::string& _publish_type) {
-        namespace fsvr = irods::experimental::filesystem::server;
+        const std::string& _data_set_id,
+        const std::string& _api_token) {
+        const std::string path{
+            boost::str(boost::format("/v0/datasets/%s/%s")
+            % _user_name
+            % _data_set_id)};
+        auto r = send_request(path, [&](const cpr::Url& _url) {
+                     return cpr::Get(
+                         _url,
+                         cpr::Header{
+                             {"Authorization", "Bearer " + _api_token}});
+                 });
+        if(200 != r.status_code) {
+            THROW(
+                SYS_INTERNAL_ERR,
+                r.text);
+        }
+
+        remote_file_listing listing;
+        nlohmann::json::sax_parse(r.text, &listing);
+        return std::move(listing.files);
+    } // list_remote_files
+
+    struct reconcile_plan {
+        // the dataset is chosen once the plan is made
+        std::vector<pending_upload> uploads;
+        std::vector<std::string>    deletes;
+        std::size_t                 skipped{};
+    }; // struct reconcile_plan
+
+    // the checksum each object beneath _collection_name had when it was last
+    // published, as its publication results record it
+    std::map<std::string, std::string> published_checksums(
+        rsComm_t*                                      _comm,
+        const std::string&                             _collection_name,
+        const irods::publishing::publication_results* _results) {
+        std::map<std::string, std::string> checksums;
+        if(!_results) {
+            return checksums;
+        }
+
+        const auto query_str = boost::str(boost::format(
+            "SELECT COLL_NAME, DATA_NAME, META_DATA_ATTR_VALUE WHERE META_DATA_ATTR_NAME = '%s' AND COLL_NAME = '%s' || like '%s/%%'")
+            % irods::publishing::escape_genquery_literal(_results->attribute("checksum"))
+            % irods::publishing::escape_genquery_literal(_collection_name)
+            % irods::publishing::escape_genquery_literal(_collection_name));
+        for(const auto& row : irods::query{_comm, query_str}) {
+            checksums[row[0] + "/" + row[1]] = row[2];
+        }
+
+        return checksums;
+    } // published_checksums
+
+    reconcile_plan plan_reconciliation(
+        rsComm_t*                                      _comm,
+        const std::string&                             _collection_name,
+        std::map<std::string, uintmax_t>               _remote,
+        const irods::publishing::publication_results* _results) {
+        // the size of a remote file alone does not show it holds the object,
+        // it is in sync only when the object was last published with the
+        // checksum the catalog has for it now
+        const auto published = published_checksums(_comm, _collection_name, _results);
+
+        // the catalog listing is paged by the query, the remote listing is
+        // consumed as local objects are matched so what remains is to be deleted
+        std::string query_str{
+            boost::str(boost::format(
+            "SELECT COLL_NAME, DATA_NAME, DATA_SIZE, DATA_CHECKSUM WHERE COLL_NAME = '%s' || like '%s/%%'")
+            % irods::publishing::escape_genquery_literal(_collection_name)
+            % irods::publishing::escape_genquery_literal(_collection_name))};
+
+        reconcile_plan plan;
+        std::set<std::string> seen;
+        for(const auto& row : irods::query{_comm, query_str}) {
+            const std::string object_path{row[0] + "/" + row[1]};
+            const auto name = remote_file_name(_collection_name, object_path);
+            // one row per replica
+            if(!seen.insert(name).second) {
+                continue;
+            }
+
+            const uintmax_t size = boost::lexical_cast<uintmax_t>(row[2]);
+            const auto itr = _remote.find(name);
+            const auto checksum = published.find(object_path);
+            if(itr != _remote.end() && itr->second == size &&
+               !row[3].empty() && checksum != published.end() && checksum->second == row[3]) {
+                ++plan.skipped;
+            }
+            else {
+                plan.uploads.push_back({object_path, name, {}, size, row[3]});
+            }
+
+            if(itr != _remote.end()) {
+                _remote.erase(itr);
+            }
+        }
+
+        for(const auto& r : _remote) {
+            plan.deletes.push_back(r.first);
+        }
+
+        return plan;
+    } // plan_reconciliation
+
+    // upload every object of the collections whose fingerprint changed, an
+    // object rewritten in place may keep its size.  removals are left to a
+    // full reconciliation
+    reconcile_plan plan_changed_reconciliation(
+        rsComm_t*                    _comm,
+        const std::string&           _collection_name,
+        const std::set<std::string>& _changed_collections) {
+        reconcile_plan plan;
+        std::set<std::string> seen;
+        for(const auto& coll : _changed_collections) {
+            std::string query_str{
+                boost::str(boost::format(
+                "SELECT DATA_NAME, DATA_SIZE, DATA_CHECKSUM WHERE COLL_NAME = '%s'")
+                % irods::publishing::escape_genquery_literal(coll))};
+            for(const auto& row : irods::query{_comm, query_str}) {
+                const std::string object_path{coll + "/" + row[0]};
+                const auto name = remote_file_name(_collection_name, object_path);
+                if(!seen.insert(name).second) {
+                    continue;
+                }
+
+                plan.uploads.push_back({object_path, name, {}, boost::lexical_cast<uintmax_t>(row[1]), row[2]});
+            }
+        }
 
+        return plan;
+    } // plan_changed_reconciliation
+
+    void invoke_reconcile_collection_policy(
+        ruleExecInfo_t*                              _rei,
+        const std::string&                           _collection_name,
+        const std::string&                           _user_name,
+        const std::string&                           _publish_type,
+        irods::publishing::pipeline_metrics*        _metrics = nullptr,
+        const irods::publishing::cancellation_check& _cancelled = {},
+        irods::publishing::publication_results*     _results = nullptr) {
         try {
-            const auto api_token{get_api_token_for_user(_rei->rsComm, _user_name)};
-            auto data_set_id = create_dataset(
-                                   _collection_name,
-                                   _user_name,
-                                   api_token);
+            rsComm_t* comm = _rei->rsComm;
+            const auto ids = get_dataset_ids(comm, _collection_name, true);
+            if(ids.empty()) {
+                // never published, nothing to compare against
+                invoke_publish_collection_policy(_rei, _collection_name, _user_name, _publish_type, _metrics, _cancelled, _results);
+                return;
+            }
 
-            rsComm_t& comm = *_rei->rsComm;
-            namespace fs   = irods::experimental::filesystem;
-            namespace fsvr = irods::experimental::filesystem::server;
-            for(auto p : fsvr::recursive_collection_iterator(comm, _collection_name)) {
-                try {
-                    if(fsvr::is_data_object(comm, p.path())) {
-                        // read the data out of irods into a buffer
-                        auto object_size = fsvr::data_object_size(*_rei->rsComm, p.path().string());
-                        irods::experimental::io::server::basic_transport<char> xport(*_rei->rsComm);
-                        irods::experimental::io::idstream ds{xport, p.path().string()};
-                        const uintmax_t read_size{object_size};
-                        char read_buff[read_size];
-                        ds.read(read_buff, read_size);
-
-                        upload_file(
-                            _user_name,
-                            data_set_id,
-                            api_token,
-                            p.path().string(),
-                            read_buff,
-                            read_size);
+            irods::publishing::collection_fingerprint fp{comm, config->fingerprint};
+            const auto delta = fp.update(_collection_name);
+            if(!delta.rebuilt && !delta.removed && delta.changed_collections.empty()) {
+                rodsLog(
+                    config->log_level,
+                    "reconcile [%s] fingerprint unchanged",
+                    _collection_name.c_str());
+                fp.commit();
+                return;
+            }
+
+            try {
+                const auto api_token{get_api_token_for_user(comm, _user_name)};
+
+                // a sharded collection is the union of its datasets, each file
+                // stays in the dataset holding it and new files go to the shard
+                // holding the fewest bytes
+                std::map<std::string, uintmax_t>              remote;
+                std::map<std::string, std::string>            owners;
+                std::map<std::string, uintmax_t>              shard_bytes;
+                std::vector<std::map<std::string, uintmax_t>> listings(ids.size());
+                std::vector<std::size_t>                      indices(ids.size());
+                std::iota(indices.begin(), indices.end(), std::size_t{0});
+                irods::publishing::parallel_for_each(
+                    indices,
+                    maximum_concurrent_requests(),
+                    [&](const std::size_t _i) {
+                        listings[_i] = list_remote_files(_user_name, ids[_i], api_token);
+                    });
+                for(std::size_t i = 0; i < ids.size(); ++i) {
+                    auto& bytes = shard_bytes[ids[i]];
+                    for(const auto& f : listings[i]) {
+                        remote[f.first] = f.second;
+                        owners[f.first] = ids[i];
+                        bytes += f.second;
                     }
                 }
-                catch(const irods::exception& _e) {
-                    rodsLog(
-                        LOG_ERROR,
-                        "failed to find indexing resource for object [%s]",
-                        p.path().string().c_str());
+
+                // only a full comparison finds the remote files of removed objects
+                const auto plan = delta.rebuilt || delta.removed ?
+                                  plan_reconciliation(comm, _collection_name, std::move(remote), _results) :
+                                  plan_changed_reconciliation(comm, _collection_name, delta.changed_collections);
+
+                rodsLog(
+                    config->log_level,
+                    "reconcile [%s] datasets [%zu] changed collections [%zu] upload [%zu] delete [%zu] skip [%zu]",
+                    _collection_name.c_str(),
+                    ids.size(),
+                    delta.changed_collections.size(),
+                    plan.uploads.size(),
+                    plan.deletes.size(),
+                    plan.skipped);
+
+                std::map<std::string, std::vector<std::string>> deletes;
+                for(const auto& name : plan.deletes) {
+                    deletes[owners[name]].push_back(name);
+                }
+                for(const auto& d : deletes) {
+                    delete_files(_user_name, d.first, api_token, d.second);
+                }
+
+                std::vector<pending_upload> uploads;
+                uploads.reserve(plan.uploads.size());
+                for(auto u : plan.uploads) {
+                    if(const auto itr = owners.find(u.file_name); itr != owners.end()) {
+                        u.data_set_id = itr->second;
+                    }
+                    else {
+                        const auto least = std::min_element(
+                                               shard_bytes.begin(),
+                                               shard_bytes.end(),
+                                               [](const auto& _l, const auto& _r) { return _l.second < _r.second; });
+                        u.data_set_id = least->first;
+                        least->second += u.size;
+                    }
+
+                    uploads.push_back(std::move(u));
+                }
+
+                const auto outcome = upload_objects(*comm, _user_name, api_token, uploads, _metrics, _cancelled, _results);
+                if(irods::publishing::cancellation_requested(_cancelled)) {
+                    // what was published no longer matches the tree
+                    fp.invalidate(_collection_name);
+                    return;
+                }
+
+                std::vector<std::string> published;
+                for(std::size_t i = 0; i < uploads.size(); ++i) {
+                    if(outcome.published[i]) {
+                        published.push_back(uploads[i].object_path);
+                    }
+                }
+                assign_persistent_identifiers(*comm, _collection_name, true, published, _results);
+
+                if(outcome.failed > 0) {
+                    THROW(
+                        SYS_INTERNAL_ERR,
+                        boost::format("[%zu] objects of [%s] failed to publish")
+                        % outcome.failed
+                        % _collection_name);
                 }
 
-            } // for
+                // the tree is stored only once the service matches it
+                fp.commit();
+            }
+            catch(...) {
+                // the tree no longer describes what was published
+                fp.invalidate(_collection_name);
+                throw;
+            }
         }
         catch(const std::runtime_error& _e) {
             rodsLog(
@@ -332,16 +1580,48 @@ namespace {
                 SYS_INTERNAL_ERR,
                 _e.what());
         }
-    } // invoke_publish_object_policy
+    } // invoke_reconcile_collection_policy
 
     void invoke_purge_object_policy(
         ruleExecInfo_t*    _rei,
         const std::string& _object_path,
-        const std::string& _source_resource,
+        const std::string& _user_name,
         const std::string& _publish_type) {
+        namespace fs = irods::experimental::filesystem;
 
         try {
-            // smart things here
+            rsComm_t* comm = _rei->rsComm;
+            const auto api_token{get_api_token_for_user(comm, _user_name)};
+
+            // an object published on its own owns its datasets
+            const auto ids = get_dataset_ids(comm, _object_path, false);
+            if(!ids.empty()) {
+                delete_datasets(_user_name, api_token, ids);
+                for(const auto& id : ids) {
+                    modify_dataset_id_metadata(comm, "rm", _object_path, false, id);
+                }
+                return;
+            }
+
+            // otherwise remove the file from the datasets of the nearest published collection
+            const fs::path object_path{_object_path};
+            for(auto coll = object_path.parent_path(); !coll.empty(); coll = coll.parent_path()) {
+                const auto coll_ids = get_dataset_ids(comm, coll.string(), true);
+                if(coll_ids.empty()) {
+                    continue;
+                }
+
+                const std::vector<std::string> names{remote_file_name(coll.string(), _object_path)};
+                for(const auto& id : coll_ids) {
+                    delete_files(_user_name, id, api_token, names);
+                }
+                return;
+            }
+
+            rodsLog(
+                config->log_level,
+                "no published dataset found for [%s]",
+                _object_path.c_str());
         }
         catch(const std::runtime_error& _e) {
             rodsLog(
@@ -363,6 +1643,99 @@ namespace {
         }
     } // invoke_purge_object_policy
 
+    void invoke_purge_collection_policy(
+        ruleExecInfo_t*    _rei,
+        const std::string& _collection_name,
+        const std::string& _user_name,
+        const std::string& _publish_type) {
+        try {
+            rsComm_t* comm = _rei->rsComm;
+            const auto api_token{get_api_token_for_user(comm, _user_name)};
+
+            const auto ids = get_dataset_ids(comm, _collection_name, true);
+            delete_datasets(_user_name, api_token, ids);
+
+            // catalog cleanup happens on this thread, the rsComm is not thread safe
+            for(const auto& id : ids) {
+                modify_dataset_id_metadata(comm, "rm", _collection_name, true, id);
+            }
+        }
+        catch(const std::runtime_error& _e) {
+            rodsLog(
+                LOG_ERROR,
+                "Exception [%s]",
+                _e.what());
+            THROW(
+                SYS_INTERNAL_ERR,
+                _e.what());
+        }
+        catch(const std::exception& _e) {
+            rodsLog(
+                LOG_ERROR,
+                "Exception [%s]",
+                _e.what());
+            THROW(
+                SYS_INTERNAL_ERR,
+                _e.what());
+        }
+    } // invoke_purge_collection_policy
+
+    const std::string service_name{"dataworld"};
+
+    class dataworld_backend : public irods::publishing::backend {
+        public:
+        void publish_object(const irods::publishing::job& _job) override {
+            invoke_publish_object_policy(
+                _job.rei,
+                _job.path,
+                _job.user_name,
+                _job.publish_type,
+                _job.metrics,
+                _job.cancelled,
+                _job.results);
+        }
+
+        void purge_object(const irods::publishing::job& _job) override {
+            invoke_purge_object_policy(
+                _job.rei,
+                _job.path,
+                _job.user_name,
+                _job.publish_type);
+        }
+
+        void publish_collection(const irods::publishing::job& _job) override {
+            invoke_publish_collection_policy(
+                _job.rei,
+                _job.path,
+                _job.user_name,
+                _job.publish_type,
+                _job.metrics,
+                _job.cancelled,
+                _job.results);
+        }
+
+        void purge_collection(const irods::publishing::job& _job) override {
+            invoke_purge_collection_policy(
+                _job.rei,
+                _job.path,
+                _job.user_name,
+                _job.publish_type);
+        }
+
+        void reconcile_collection(const irods::publishing::job& _job) override {
+            invoke_reconcile_collection_policy(
+                _job.rei,
+                _job.path,
+                _job.user_name,
+                _job.publish_type,
+                _job.metrics,
+                _job.cancelled,
+                _job.results);
+        }
+    }; // class dataworld_backend
+
+    dataworld_backend backend;
+
 } // namespace
 
 irods::error start(
@@ -370,6 +1743,8 @@ irods::error start(
     const std::string& _instance_name ) {
     RuleExistsHelper::Instance()->registerRuleRegex("irods_policy_.*");
     config = std::make_unique<configuration>(_instance_name);
+    hosts  = make_host_pool();
+    pids   = make_pid_pool(_instance_name);
     object_publish_policy = irods::publishing::policy::compose_policy_name(
                                irods::publishing::policy::object::publish,
                                "dataworld");
@@ -382,12 +1757,17 @@ irods::error start(
     collection_purge_policy = irods::publishing::policy::compose_policy_name(
                                irods::publishing::policy::collection::purge,
                                "dataworld");
+    collection_reconcile_policy = irods::publishing::policy::compose_policy_name(
+                               irods::publishing::policy::collection::reconcile,
+                               "dataworld");
+    irods::publishing::backend_registry::instance().add(service_name, &backend);
     return SUCCESS();
 }
 
 irods::error stop(
     irods::default_re_ctx&,
     const std::string& ) {
+    irods::publishing::backend_registry::instance().remove(service_name);
     return SUCCESS();
 }
 
@@ -398,7 +1778,8 @@ irods::error rule_exists(
     _ret = object_publish_policy     == _rn ||
            object_purge_policy       == _rn ||
            collection_publish_policy == _rn ||
-           collection_purge_policy   == _rn;
+           collection_purge_policy   == _rn ||
+           collection_reconcile_policy == _rn;
     return SUCCESS();
 }
 
@@ -409,6 +1790,7 @@ irods::error list_rules(
     _rules.push_back(object_purge_policy);
     _rules.push_back(collection_publish_policy);
     _rules.push_back(collection_purge_policy);
+    _rules.push_back(collection_reconcile_policy);
     return SUCCESS();
 }
 
@@ -466,6 +1848,24 @@ irods::error exec_rule(
             const std::string collection_name{ boost::any_cast<std::string>(*it) }; ++it;
             const std::string user_name{ boost::any_cast<std::string>(*it) }; ++it;
             const std::string publish_type{ boost::any_cast<std::string>(*it) }; ++it;
+
+            invoke_purge_collection_policy(
+                rei,
+                collection_name,
+                user_name,
+                publish_type);
+        }
+        else if(_rn == collection_reconcile_policy) {
+            auto it = _args.begin();
+            const std::string collection_name{ boost::any_cast<std::string>(*it) }; ++it;
+            const std::string user_name{ boost::any_cast<std::string>(*it) }; ++it;
+            const std::string publish_type{ boost::any_cast<std::string>(*it) }; ++it;
+
+            invoke_reconcile_collection_policy(
+                rei,
+                collection_name,
+                user_name,
+                publish_type);
         }
         else {
             return ERROR(
@@ -0,0 +1,661 @@
+#define IRODS_IO_TRANSPORT_ENABLE_SERVER_SIDE_API
+
+#include <irods/irods_query.hpp>
+#include <irods/irods_re_plugin.hpp>
+#include <irods/irods_re_ruleexistshelper.hpp>
+#include "utilities.hpp"
+#include "plugin_specific_configuration.hpp"
+#include "configuration.hpp"
+#include "publishing_backend.hpp"
+#include "replica_utilities.hpp"
+#include "fingerprint.hpp"
+#include "genquery_builder.hpp"
+#include <irods/dstream.hpp>
+
+#define IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+#include <irods/transport/default_transport.hpp>
+#include <irods/filesystem.hpp>
+
+#include <boost/any.hpp>
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <ctime>
+#include <string>
+#include <set>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    struct configuration : irods::publishing::configuration {
+        std::string root_directory;
+        configuration(const std::string& _instance_name) :
+            irods::publishing::configuration(_instance_name) {
+            auto cfg = irods::publishing::get_plugin_specific_configuration(_instance_name);
+            if(cfg.find("root_directory") == cfg.end()) {
+                THROW(
+                    KEY_NOT_FOUND,
+                    boost::format("root_directory is not configured for [%s]")
+                    % _instance_name);
+            }
+            root_directory = cfg.at("root_directory").get<std::string>();
+        }// ctor
+    }; // configuration
+
+    std::unique_ptr<configuration> config;
+    std::string object_publish_policy;
+    std::string object_purge_policy;
+    std::string collection_publish_policy;
+    std::string collection_purge_policy;
+    std::string collection_reconcile_policy;
+
+    const std::string service_name{"directory"};
+    constexpr std::size_t copy_buffer_size{4 * 1024 * 1024};
+
+    // logical paths are mirrored beneath the root directory
+    boost::filesystem::path target_path(
+        const std::string& _logical_path) {
+        return boost::filesystem::path{config->root_directory} / _logical_path;
+    } // target_path
+
+    class file_descriptor {
+        public:
+        file_descriptor(const char* _path, const int _flags, const mode_t _mode = 0) :
+            fd_{::open(_path, _flags, _mode)} {
+            if(fd_ < 0) {
+                THROW(
+                    UNIX_FILE_OPEN_ERR - errno,
+                    boost::format("failed to open [%s]")
+                    % _path);
+            }
+        }
+        ~file_descriptor() { ::close(fd_); }
+
+        file_descriptor(const file_descriptor&) = delete;
+        file_descriptor& operator=(const file_descriptor&) = delete;
+
+        int get() const { return fd_; }
+
+        private:
+        int fd_;
+    }; // class file_descriptor
+
+    // copy between two local files without staging the data in user space,
+    // copy_file_range first then sendfile for filesystems which refuse it
+    void copy_local_file(
+        const std::string& _source,
+        const std::string& _target) {
+        file_descriptor in{_source.c_str(), O_RDONLY};
+        file_descriptor out{_target.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644};
+
+        struct stat st{};
+        if(0 != fstat(in.get(), &st)) {
+            THROW(
+                UNIX_FILE_STAT_ERR - errno,
+                boost::format("failed to stat [%s]")
+                % _source);
+        }
+
+        off_t remaining = st.st_size;
+        bool use_sendfile = false;
+        while(remaining > 0) {
+            ssize_t n = -1;
+            if(!use_sendfile) {
+                n = copy_file_range(in.get(), nullptr, out.get(), nullptr, remaining, 0);
+                if(n < 0 && (EXDEV == errno || ENOSYS == errno || EINVAL == errno || EOPNOTSUPP == errno)) {
+                    use_sendfile = true;
+                    continue;
+                }
+            }
+            else {
+                n = sendfile(out.get(), in.get(), nullptr, remaining);
+            }
+
+            if(n < 0) {
+                THROW(
+                    UNIX_FILE_WRITE_ERR - errno,
+                    boost::format("failed to copy [%s] to [%s]")
+                    % _source
+                    % _target);
+            }
+            if(0 == n) {
+                break;
+            }
+            remaining -= n;
+        }
+    } // copy_local_file
+
+    void stream_object(
+        rsComm_t&                                    _comm,
+        const std::string&                           _object_path,
+        const int                                    _replica_number,
+        const std::string&                           _target,
+        const irods::publishing::cancellation_check& _cancelled) {
+        namespace io = irods::experimental::io;
+        io::server::basic_transport<char> xport(_comm);
+        io::idstream ds{xport, _object_path, io::replica_number{_replica_number}};
+        if(!ds.is_open()) {
+            THROW(
+                SYS_INTERNAL_ERR,
+                boost::format("failed to open replica [%d] of [%s]")
+                % _replica_number
+                % _object_path);
+        }
+
+        file_descriptor out{_target.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644};
+
+        std::vector<char> buffer(copy_buffer_size);
+        while(ds && !irods::publishing::cancellation_requested(_cancelled)) {
+            ds.read(buffer.data(), buffer.size());
+            const auto count = ds.gcount();
+            for(std::streamsize written = 0; written < count;) {
+                const auto n = ::write(out.get(), buffer.data() + written, count - written);
+                if(n < 0) {
+                    THROW(
+                        UNIX_FILE_WRITE_ERR - errno,
+                        boost::format("failed to write [%s]")
+                        % _target);
+                }
+                written += n;
+            }
+        }
+    } // stream_object
+
+    void publish_object_to(
+        rsComm_t&                                    _comm,
+        const std::string&                           _object_path,
+        const std::string&                           _target,
+        irods::publishing::pipeline_metrics*        _metrics,
+        const irods::publishing::cancellation_check& _cancelled,
+        irods::publishing::publication_results*     _results) {
+        using irods::publishing::pipeline_metrics;
+        boost::filesystem::create_directories(boost::filesystem::path{_target}.parent_path());
+
+        // reading and writing are one operation here, reported as the upload
+        const auto start  = pipeline_metrics::now();
+        const auto source = irods::publishing::select_replica_for_read(
+                                _comm,
+                                _object_path,
+                                config->replica_selection);
+        if(!source) {
+            THROW(
+                SYS_NO_GOOD_REPLICA,
+                boost::format("no good replica to publish [%s]")
+                % _object_path);
+        }
+
+        if(const auto vault_path = irods::publishing::local_vault_path(*source)) {
+            copy_local_file(*vault_path, _target);
+        }
+        else {
+            stream_object(_comm, _object_path, source->number, _target, _cancelled);
+        }
+
+        if(_metrics) {
+            _metrics->object_uploaded(
+                boost::filesystem::file_size(_target),
+                pipeline_metrics::now() - start);
+        }
+
+        // a cancelled stream leaves a partial file, which is purged
+        if(_results && !irods::publishing::cancellation_requested(_cancelled)) {
+            _results->record(_object_path, false, _results->attribute("directory::file"), _target);
+            _results->record(_object_path, false, _results->attribute("published_at"), std::to_string(std::time(nullptr)));
+            _results->flush_if_full(_comm);
+        }
+    } // publish_object_to
+
+    void invoke_publish_object_policy(
+        ruleExecInfo_t*                              _rei,
+        const std::string&                           _object_path,
+        const std::string&                           _user_name,
+        const std::string&                           _publish_type,
+        irods::publishing::pipeline_metrics*        _metrics = nullptr,
+        const irods::publishing::cancellation_check& _cancelled = {},
+        irods::publishing::publication_results*     _results = nullptr) {
+        try {
+            publish_object_to(*_rei->rsComm, _object_path, target_path(_object_path).string(), _metrics, _cancelled, _results);
+        }
+        catch(const std::exception& _e) {
+            rodsLog(
+                LOG_ERROR,
+                "Exception [%s]",
+                _e.what());
+            THROW(
+                SYS_INTERNAL_ERR,
+                _e.what());
+        }
+    } // invoke_publish_object_policy
+
+    void invoke_publish_collection_policy(
+        ruleExecInfo_t*                              _rei,
+        const std::string&                           _collection_name,
+        const std::string&                           _user_name,
+        const std::string&                           _publish_type,
+        irods::publishing::pipeline_metrics*        _metrics = nullptr,
+        const irods::publishing::cancellation_check& _cancelled = {},
+        irods::publishing::publication_results*     _results = nullptr) {
+        namespace fsvr = irods::experimental::filesystem::server;
+
+        try {
+            rsComm_t& comm = *_rei->rsComm;
+            std::size_t failed{};
+            for(auto p : fsvr::recursive_collection_iterator(comm, _collection_name)) {
+                if(irods::publishing::cancellation_requested(_cancelled)) {
+                    return;
+                }
+
+                // a full disk or a denied write fails the object as an irods
+                // error does, the rest of the collection is still published
+                const auto object_failed = [&](const char* _what) {
+                    rodsLog(
+                        LOG_ERROR,
+                        "failed to publish object [%s] [%s]",
+                        p.path().string().c_str(),
+                        _what);
+                    if(_metrics) {
+                        _metrics->object_failed();
+                    }
+                    ++failed;
+                };
+
+                try {
+                    if(fsvr::is_data_object(comm, p.path())) {
+                        publish_object_to(comm, p.path().string(), target_path(p.path().string()).string(), _metrics, _cancelled, _results);
+                    }
+                }
+                catch(const irods::exception& _e) {
+                    object_failed(_e.client_display_what());
+                }
+                catch(const std::exception& _e) {
+                    object_failed(_e.what());
+                }
+            } // for
+
+            // the rest of the collection is published, the job fails
+            if(failed > 0) {
+                THROW(
+                    SYS_INTERNAL_ERR,
+                    boost::format("[%zu] objects of [%s] failed to publish")
+                    % failed
+                    % _collection_name);
+            }
+        }
+        catch(const std::exception& _e) {
+            rodsLog(
+                LOG_ERROR,
+                "Exception [%s]",
+                _e.what());
+            THROW(
+                SYS_INTERNAL_ERR,
+                _e.what());
+        }
+    } // invoke_publish_collection_policy
+
+    void invoke_purge_policy(
+        const std::string& _logical_path) {
+        try {
+            boost::filesystem::remove_all(target_path(_logical_path));
+        }
+        catch(const std::exception& _e) {
+            rodsLog(
+                LOG_ERROR,
+                "Exception [%s]",
+                _e.what());
+            THROW(
+                SYS_INTERNAL_ERR,
+                _e.what());
+        }
+    } // invoke_purge_policy
+
+    void invoke_reconcile_collection_policy(
+        ruleExecInfo_t*                              _rei,
+        const std::string&                           _collection_name,
+        const std::string&                           _user_name,
+        const std::string&                           _publish_type,
+        irods::publishing::pipeline_metrics*        _metrics = nullptr,
+        const irods::publishing::cancellation_check& _cancelled = {},
+        irods::publishing::publication_results*     _results = nullptr) {
+        namespace bfs = boost::filesystem;
+
+        try {
+            rsComm_t& comm = *_rei->rsComm;
+            std::string query_str{
+                boost::str(boost::format(
+                "SELECT COLL_NAME, DATA_NAME, DATA_SIZE WHERE COLL_NAME = '%s' || like '%s/%%'")
+                % irods::publishing::escape_genquery_literal(_collection_name)
+                % irods::publishing::escape_genquery_literal(_collection_name))};
+
+            const auto stopped = [&] {
+                if(!irods::publishing::cancellation_requested(_cancelled)) {
+                    return false;
+                }
+
+                // what was published no longer matches the tree
+                irods::publishing::collection_fingerprint fp{&comm, config->fingerprint};
+                fp.invalidate(_collection_name);
+                return true;
+            };
+
+            std::set<std::string> local;
+            for(const auto& row : irods::query{&comm, query_str}) {
+                if(stopped()) {
+                    return;
+                }
+
+                const std::string object_path{row[0] + "/" + row[1]};
+                if(!local.insert(target_path(object_path).string()).second) {
+                    continue;
+                }
+
+                const auto target = target_path(object_path);
+                boost::system::error_code ec;
+                const auto size = bfs::file_size(target, ec);
+                if(ec || std::to_string(size) != row[2]) {
+                    publish_object_to(comm, object_path, target.string(), _metrics, _cancelled, _results);
+                }
+            }
+
+            // a stream cut short leaves the last object partly written
+            if(stopped()) {
+                return;
+            }
+
+            const auto root = target_path(_collection_name);
+            if(!bfs::exists(root)) {
+                return;
+            }
+
+            std::vector<bfs::path> stale;
+            for(const auto& e : bfs::recursive_directory_iterator(root)) {
+                if(bfs::is_regular_file(e.path()) && 0 == local.count(e.path().string())) {
+                    stale.push_back(e.path());
+                }
+            }
+            for(const auto& s : stale) {
+                bfs::remove(s);
+            }
+        }
+        catch(const std::exception& _e) {
+            rodsLog(
+                LOG_ERROR,
+                "Exception [%s]",
+                _e.what());
+            THROW(
+                SYS_INTERNAL_ERR,
+                _e.what());
+        }
+    } // invoke_reconcile_collection_policy
+
+    class directory_backend : public irods::publishing::backend {
+        public:
+        void publish_object(const irods::publishing::job& _job) override {
+            invoke_publish_object_policy(
+                _job.rei,
+                _job.path,
+                _job.user_name,
+                _job.publish_type,
+                _job.metrics,
+                _job.cancelled,
+                _job.results);
+        }
+
+        void purge_object(const irods::publishing::job& _job) override {
+            invoke_purge_policy(_job.path);
+        }
+
+        void publish_collection(const irods::publishing::job& _job) override {
+            invoke_publish_collection_policy(
+                _job.rei,
+                _job.path,
+                _job.user_name,
+                _job.publish_type,
+                _job.metrics,
+                _job.cancelled,
+                _job.results);
+        }
+
+        void purge_collection(const irods::publishing::job& _job) override {
+            invoke_purge_policy(_job.path);
+        }
+
+        void reconcile_collection(const irods::publishing::job& _job) override {
+            invoke_reconcile_collection_policy(
+                _job.rei,
+                _job.path,
+                _job.user_name,
+                _job.publish_type,
+                _job.metrics,
+                _job.cancelled,
+                _job.results);
+        }
+    }; // class directory_backend
+
+    directory_backend backend;
+
+} // namespace
+
+irods::error start(
+    irods::default_re_ctx&,
+    const std::string& _instance_name ) {
+    RuleExistsHelper::Instance()->registerRuleRegex("irods_policy_.*");
+    config = std::make_unique<configuration>(_instance_name);
+    object_publish_policy = irods::publishing::policy::compose_policy_name(
+                               irods::publishing::policy::object::publish,
+                               service_name);
+    object_purge_policy = irods::publishing::policy::compose_policy_name(
+                               irods::publishing::policy::object::purge,
+                               service_name);
+    collection_publish_policy = irods::publishing::policy::compose_policy_name(
+                               irods::publishing::policy::collection::publish,
+                               service_name);
+    collection_purge_policy = irods::publishing::policy::compose_policy_name(
+                               irods::publishing::policy::collection::purge,
+                               service_name);
+    collection_reconcile_policy = irods::publishing::policy::compose_policy_name(
+                               irods::publishing::policy::collection::reconcile,
+                               service_name);
+    irods::publishing::backend_registry::instance().add(service_name, &backend);
+    return SUCCESS();
+}
+
+irods::error stop(
+    irods::default_re_ctx&,
+    const std::string& ) {
+    irods::publishing::backend_registry::instance().remove(service_name);
+    return SUCCESS();
+}
+
+irods::error rule_exists(
+    irods::default_re_ctx&,
+    const std::string& _rn,
+    bool&              _ret) {
+    _ret = object_publish_policy       == _rn ||
+           object_purge_policy         == _rn ||
+           collection_publish_policy   == _rn ||
+           collection_purge_policy     == _rn ||
+           collection_reconcile_policy == _rn;
+    return SUCCESS();
+}
+
+irods::error list_rules(
+    irods::default_re_ctx&,
+    std::vector<std::string>& _rules) {
+    _rules.push_back(object_publish_policy);
+    _rules.push_back(object_purge_policy);
+    _rules.push_back(collection_publish_policy);
+    _rules.push_back(collection_purge_policy);
+    _rules.push_back(collection_reconcile_policy);
+    return SUCCESS();
+}
+
+irods::error exec_rule(
+    irods::default_re_ctx&,
+    const std::string&     _rn,
+    std::list<boost::any>& _args,
+    irods::callback        _eff_hdlr) {
+    ruleExecInfo_t* rei{};
+    const auto err = _eff_hdlr("unsafe_ms_ctx", &rei);
+    if(!err.ok()) {
+        return err;
+    }
+
+    try {
+        auto it = _args.begin();
+        const std::string path{ boost::any_cast<std::string>(*it) }; ++it;
+        const std::string user_name{ boost::any_cast<std::string>(*it) }; ++it;
+        const std::string publish_type{ boost::any_cast<std::string>(*it) }; ++it;
+        const irods::publishing::job job{rei, path, user_name, publish_type};
+
+        if(_rn == object_publish_policy) {
+            backend.publish_object(job);
+        }
+        else if(_rn == object_purge_policy) {
+            backend.purge_object(job);
+        }
+        else if(_rn == collection_publish_policy) {
+            backend.publish_collection(job);
+        }
+        else if(_rn == collection_purge_policy) {
+            backend.purge_collection(job);
+        }
+        else if(_rn == collection_reconcile_policy) {
+            backend.reconcile_collection(job);
+        }
+        else {
+            return ERROR(
+                    SYS_NOT_SUPPORTED,
+                    _rn);
+        }
+    }
+    catch(const boost::bad_any_cast& _e) {
+        irods::publishing::exception_to_rerror(
+            INVALID_ANY_CAST,
+            _e.what(),
+            rei->rsComm->rError);
+        return ERROR(
+                   SYS_NOT_SUPPORTED,
+                   _e.what());
+    }
+    catch(const irods::exception& _e) {
+        irods::publishing::exception_to_rerror(
+            _e,
+            rei->rsComm->rError);
+        return irods::error(_e);
+    }
+
+    return err;
+
+} // exec_rule
+
+irods::error exec_rule_text(
+    irods::default_re_ctx&,
+    const std::string&,
+    msParamArray_t*,
+    const std::string&,
+    irods::callback ) {
+    return ERROR(
+            RULE_ENGINE_CONTINUE,
+            "exec_rule_text is not supported");
+} // exec_rule_text
+
+irods::error exec_rule_expression(
+    irods::default_re_ctx&,
+    const std::string&,
+    msParamArray_t*,
+    irods::callback) {
+    return ERROR(
+            RULE_ENGINE_CONTINUE,
+            "exec_rule_expression is not supported");
+} // exec_rule_expression
+
+extern "C"
+irods::pluggable_rule_engine<irods::default_re_ctx>* plugin_factory(
+    const std::string& _inst_name,
+    const std::string& _context ) {
+    irods::pluggable_rule_engine<irods::default_re_ctx>* re =
+        new irods::pluggable_rule_engine<irods::default_re_ctx>(
+                _inst_name,
+                _context);
+    re->add_operation<
+        irods::default_re_ctx&,
+        const std::string&>(
+            "start",
+            std::function<
+                irods::error(
+                    irods::default_re_ctx&,
+                    const std::string&)>(start));
+    re->add_operation<
+        irods::default_re_ctx&,
+        const std::string&>(
+            "stop",
+            std::function<
+                irods::error(
+                    irods::default_re_ctx&,
+                    const std::string&)>(stop));
+    re->add_operation<
+        irods::default_re_ctx&,
+        const std::string&,
+        bool&>(
+            "rule_exists",
+            std::function<
+                irods::error(
+                    irods::default_re_ctx&,
+                    const std::string&,
+                    bool&)>(rule_exists));
+    re->add_operation<
+        irods::default_re_ctx&,
+        std::vector<std::string>&>(
+            "list_rules",
+            std::function<
+                irods::error(
+                    irods::default_re_ctx&,
+                    std::vector<std::string>&)>(list_rules));
+    re->add_operation<
+        irods::default_re_ctx&,
+        const std::string&,
+        std::list<boost::any>&,
+        irods::callback>(
+            "exec_rule",
+            std::function<
+                irods::error(
+                    irods::default_re_ctx&,
+                    const std::string&,
+                    std::list<boost::any>&,
+                    irods::callback)>(exec_rule));
+    re->add_operation<
+        irods::default_re_ctx&,
+        const std::string&,
+        msParamArray_t*,
+        const std::string&,
+        irods::callback>(
+            "exec_rule_text",
+            std::function<
+                irods::error(
+                    irods::default_re_ctx&,
+                    const std::string&,
+                    msParamArray_t*,
+                    const std::string&,
+                    irods::callback)>(exec_rule_text));
+
+    re->add_operation<
+        irods::default_re_ctx&,
+        const std::string&,
+        msParamArray_t*,
+        irods::callback>(
+            "exec_rule_expression",
+            std::function<
+                irods::error(
+                    irods::default_re_ctx&,
+                    const std::string&,
+                    msParamArray_t*,
+                    irods::callback)>(exec_rule_expression));
+    return re;
+
+} // plugin_factory
@@ -7,9 +7,20 @@
 #include <irods/irods_resource_backport.hpp>
 #include <irods/irods_query.hpp>
 #include <irods/rsModAVUMetadata.hpp>
+#include <irods/bulkDataObjPut.h>
+#include <irods/dataObjCopy.h>
+#include <irods/scoped_privileged_client.hpp>
 
 #include "utilities.hpp"
 #include "publishing_utilities.hpp"
+#include "job_slot.hpp"
+#include "publishing_backend.hpp"
+#include "pep_dispatch_table.hpp"
+#include "fingerprint.hpp"
+#include "pep_metrics.hpp"
+#include "job_table.hpp"
+#include "genquery_catalog.hpp"
+#include "published_path_filter.hpp"
 
 #undef LIST
 
@@ -26,6 +37,7 @@
 #include <boost/exception/all.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/optional.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include <nlohmann/json.hpp>
 
@@ -38,10 +50,18 @@ int _delayExec(
     const char *delayCondition,
     ruleExecInfo_t *rei );
 
+int _writeString(
+    char*           writeId,
+    char*           writeStr,
+    ruleExecInfo_t* rei);
+
 namespace {
     bool metadata_is_new = false;
-    std::unique_ptr<irods::publishing::configuration>     config;
-    std::map<int, std::tuple<std::string, std::string>> opened_objects;
+    std::unique_ptr<irods::publishing::configuration>         config;
+    std::unique_ptr<irods::publishing::job_table>             jobs;
+    std::unique_ptr<irods::publishing::published_path_filter> published_paths;
+    uint64_t                                                  published_filter_refresh_interval{};
+    std::map<int, std::tuple<std::string, std::string>>       opened_objects;
 
     std::tuple<int, std::string>
     get_index_and_resource(const dataObjInp_t* _inp) {
@@ -81,163 +101,405 @@ namespace {
     } // user_has_administrative_privileges
 
 
-    void apply_publishing_policy(
-        const std::string &    _rn,
-        ruleExecInfo_t*        _rei,
+    template<typename T>
+    T get_pep_input(
         std::list<boost::any>& _args) {
-        try {
-            std::string object_path;
-            std::string source_resource;
-            // NOTE:: 3rd parameter is the target
-            if("pep_api_data_obj_open_pre"   == _rn ||
-               "pep_api_data_obj_create_pre" == _rn ||
-               "pep_api_data_obj_put_pre"    == _rn ||
-               "pep_api_data_obj_unlink_pre" == _rn) {
-                auto it = _args.begin();
-                std::advance(it, 2);
-                if(_args.end() == it) {
-                    THROW(
-                        SYS_INVALID_INPUT_PARAM,
-                        "invalid number of arguments");
-                }
+        // NOTE:: 3rd parameter is the target
+        auto it = _args.begin();
+        std::advance(it, 2);
+        if(_args.end() == it) {
+            THROW(
+                SYS_INVALID_INPUT_PARAM,
+                "invalid number of arguments");
+        }
 
-                auto obj_inp = boost::any_cast<dataObjInp_t*>(*it);
-                if(obj_inp->openFlags & O_WRONLY || obj_inp->openFlags & O_RDWR) {
-                    irods::publishing::publisher idx{_rei, config->instance_name_};
-                    if(idx.publishing_metadata_exists_in_path(obj_inp->objPath)) {
-                        THROW(
-                            SYS_INVALID_OPR_TYPE,
-                            boost::format("object is published and now immutable [%s]")
-                            % obj_inp->objPath);
-                    }
-                }
+        return boost::any_cast<T>(*it);
+    } // get_pep_input
+
+    using irods::publishing::path_check;
+
+    // an existing object is only written in place when the client forces an
+    // overwrite or registers another replica, otherwise creating it fails
+    path_check widen_for_overwrite(
+        const keyValPair_t& _cond_input,
+        const path_check    _check) {
+        if(getValByKey(&_cond_input, FORCE_FLAG_KW) || getValByKey(&_cond_input, REG_REPL_KW)) {
+            return path_check::object_and_ancestors;
+        }
+
+        return _check;
+    } // widen_for_overwrite
+
+    // true when the filter of published paths shows that nothing _check
+    // covers of any of _paths is published, sparing the catalog queries.  a
+    // filter older than the refresh interval is rebuilt first
+    bool published_filter_excludes(
+        ruleExecInfo_t*                 _rei,
+        const std::vector<std::string>& _paths,
+        const path_check                _check) {
+        if(!published_paths) {
+            return false;
+        }
+
+        if(published_paths->stale(published_filter_refresh_interval)) {
+            try {
+                // the filter is shared by every client, so the scan must see
+                // every published path rather than those this client may read
+                irods::experimental::scoped_privileged_client privileged{*_rei->rsComm};
+                irods::publishing::genquery_catalog catalog{_rei->rsComm};
+                published_paths->rebuild(catalog, config->publish);
             }
-            else if("pep_api_rm_coll_pre" == _rn) {
-                auto it = _args.begin();
-                std::advance(it, 2);
-                if(_args.end() == it) {
-                    THROW(
-                        SYS_INVALID_INPUT_PARAM,
-                        "invalid number of arguments");
-                }
+            catch(const std::exception& _e) {
+                rodsLog(
+                    LOG_ERROR,
+                    "failed to rebuild the published path filter [%s]",
+                    _e.what());
+            }
+        }
 
-                auto coll_inp = boost::any_cast<collInp_t*>(*it);
-                irods::publishing::publisher idx{_rei, config->instance_name_};
-                if(idx.publishing_metadata_exists_in_path(coll_inp->collName)) {
-                    THROW(
-                        SYS_INVALID_OPR_TYPE,
-                        boost::format("collection is published and now immutable [%s]")
-                        % coll_inp->collName);
-                }
+        for(const auto& p : _paths) {
+            if(!published_paths->excludes(p, _check)) {
+                return false;
+            }
+        }
 
+        return true;
+    } // published_filter_excludes
+
+    void check_opened_object_is_mutable(
+        const std::string&     _rn,
+        ruleExecInfo_t*        _rei,
+        std::list<boost::any>& _args,
+        const path_check       _check) {
+        auto obj_inp = get_pep_input<dataObjInp_t*>(_args);
+        if(!(obj_inp->openFlags & O_WRONLY || obj_inp->openFlags & O_RDWR)) {
+            return;
+        }
+
+        if(published_filter_excludes(_rei, {obj_inp->objPath}, _check)) {
+            return;
+        }
+
+        irods::publishing::publisher idx{_rei, config->instance_name_};
+        if(idx.publishing_metadata_exists_in_path(obj_inp->objPath, _check)) {
+            THROW(
+                SYS_INVALID_OPR_TYPE,
+                boost::format("object is published and now immutable [%s]")
+                % obj_inp->objPath);
+        }
+    } // check_opened_object_is_mutable
+
+    void check_data_object_is_mutable(
+        const std::string&     _rn,
+        ruleExecInfo_t*        _rei,
+        std::list<boost::any>& _args,
+        const path_check       _check) {
+        auto obj_inp = get_pep_input<dataObjInp_t*>(_args);
+        const auto check = widen_for_overwrite(obj_inp->condInput, _check);
+        if(published_filter_excludes(_rei, {obj_inp->objPath}, check)) {
+            return;
+        }
+
+        irods::publishing::publisher idx{_rei, config->instance_name_};
+        if(idx.publishing_metadata_exists_in_path(obj_inp->objPath, check)) {
+            THROW(
+                SYS_INVALID_OPR_TYPE,
+                boost::format("object is published and now immutable [%s]")
+                % obj_inp->objPath);
+        }
+    } // check_data_object_is_mutable
+
+    void check_data_objects_are_mutable(
+        ruleExecInfo_t*                 _rei,
+        const std::vector<std::string>& _object_paths,
+        const path_check                _check) {
+        if(_object_paths.empty() || published_filter_excludes(_rei, _object_paths, _check)) {
+            return;
+        }
+
+        irods::publishing::publisher idx{_rei, config->instance_name_};
+        const auto published = idx.published_object_in_paths(_object_paths, _check);
+        if(!published.empty()) {
+            THROW(
+                SYS_INVALID_OPR_TYPE,
+                boost::format("object is published and now immutable [%s]")
+                % published);
+        }
+    } // check_data_objects_are_mutable
+
+    void check_bulk_put_is_mutable(
+        const std::string&     _rn,
+        ruleExecInfo_t*        _rei,
+        std::list<boost::any>& _args,
+        const path_check       _check) {
+        auto bulk_inp = get_pep_input<bulkOprInp_t*>(_args);
+        auto& attributes = bulk_inp->attriArray;
+
+        // the logical path of every object in the bundle is carried in the
+        // data name column
+        std::vector<std::string> object_paths;
+        if(const auto names = getSqlResultByInx(&attributes, COL_DATA_NAME)) {
+            object_paths.reserve(attributes.rowCnt);
+            for(int i = 0; i < attributes.rowCnt; ++i) {
+                object_paths.emplace_back(names->value + i * names->len);
             }
-            else if("pep_api_mod_avu_metadata_pre" == _rn) {
-                auto it = _args.begin();
-                std::advance(it, 2);
-                if(_args.end() == it) {
-                    THROW(
-                        SYS_INVALID_INPUT_PARAM,
-                        "invalid number of arguments");
-                }
+        }
 
-                const auto avu_inp = boost::any_cast<modAVUMetadataInp_t*>(*it);
-                const std::string attribute{avu_inp->arg3};
-                if(config->publish != attribute) {
-                    return;
-                }
+        check_data_objects_are_mutable(
+            _rei,
+            object_paths,
+            widen_for_overwrite(bulk_inp->condInput, _check));
+    } // check_bulk_put_is_mutable
 
-                const std::string operation{avu_inp->arg0};
-                const std::string type{avu_inp->arg1};
-                const std::string object_path{avu_inp->arg2};
-                const std::string add{"add"};
-                const std::string set{"set"};
-                const std::string rm{"rm"};
-                const std::string collection{"-C"};
-                const std::string object{"-d"};
-
-                irods::publishing::publisher idx{_rei, config->instance_name_};
-                // was the added tag a publishing indicator?
-                // verify that this is not new metadata with a query and set a flag
-                if(type == collection) {
-                    metadata_is_new = !idx.metadata_exists_on_collection(
-                                                     object_path,
-                                                     avu_inp->arg3,
-                                                     avu_inp->arg4,
-                                                     avu_inp->arg5);
-                }
-                else if(type == object) {
-                    metadata_is_new = !idx.metadata_exists_on_object(
-                                                     object_path,
-                                                     avu_inp->arg3,
-                                                     avu_inp->arg4,
-                                                     avu_inp->arg5);
-                }
+    void check_rename_is_mutable(
+        const std::string&     _rn,
+        ruleExecInfo_t*        _rei,
+        std::list<boost::any>& _args,
+        const path_check       _check) {
+        auto copy_inp = get_pep_input<dataObjCopyInp_t*>(_args);
+        const std::string source{copy_inp->srcDataObjInp.objPath};
+        const std::string destination{copy_inp->destDataObjInp.objPath};
 
-                if(operation == rm && !user_has_administrative_privileges(_rei)) {
-                    THROW(
-                        SYS_INVALID_OPR_TYPE,
-                        boost::format("publishing metadata tags are immutable [%s]")
-                        % object_path);
-                }
+        // an object renamed within its collection shares every lookup with
+        // its new name, anywhere else the new name cannot exist yet
+        const auto same_collection = irods::publishing::parent_collection(source) ==
+                                     irods::publishing::parent_collection(destination);
+        if(RENAME_DATA_OBJ == copy_inp->srcDataObjInp.oprType && same_collection) {
+            check_data_objects_are_mutable(_rei, {source, destination}, _check);
+            return;
+        }
+
+        irods::publishing::publisher idx{_rei, config->instance_name_};
+        const std::pair<const std::string&, path_check> targets[]{
+            {source,      _check},
+            {destination, path_check::parent_only}};
+        for(const auto& t : targets) {
+            if(published_filter_excludes(_rei, {t.first}, t.second)) {
+                continue;
             }
-            else if("pep_api_mod_avu_metadata_post" == _rn) {
-                auto it = _args.begin();
-                std::advance(it, 2);
-                if(_args.end() == it) {
-                    THROW(
-                        SYS_INVALID_INPUT_PARAM,
-                        "invalid number of arguments");
-                }
 
-                const auto avu_inp = boost::any_cast<modAVUMetadataInp_t*>(*it);
-                const std::string operation{avu_inp->arg0};
-                const std::string type{avu_inp->arg1};
-                const std::string logical_path{avu_inp->arg2};
-                const std::string attribute{avu_inp->arg3};
-                const std::string value{avu_inp->arg4};
-                const std::string units{avu_inp->arg5};
-                const std::string add{"add"};
-                const std::string set{"set"};
-                const std::string rm{"rm"};
-                const std::string collection{"-C"};
-                const std::string data_object{"-d"};
-
-                // no work to do if this is not a publication attribute
-                if(config->publish != attribute) {
-                    return;
+            if(idx.publishing_metadata_exists_in_path(t.first, t.second)) {
+                THROW(
+                    SYS_INVALID_OPR_TYPE,
+                    boost::format("path is published and now immutable [%s]")
+                    % t.first);
+            }
+        }
+    } // check_rename_is_mutable
+
+    void check_copy_destination_is_mutable(
+        const std::string&     _rn,
+        ruleExecInfo_t*        _rei,
+        std::list<boost::any>& _args,
+        const path_check       _check) {
+        auto copy_inp = get_pep_input<dataObjCopyInp_t*>(_args);
+        check_data_objects_are_mutable(
+            _rei,
+            {copy_inp->destDataObjInp.objPath},
+            widen_for_overwrite(copy_inp->destDataObjInp.condInput, _check));
+    } // check_copy_destination_is_mutable
+
+    void check_collection_is_mutable(
+        const std::string&     _rn,
+        ruleExecInfo_t*        _rei,
+        std::list<boost::any>& _args,
+        const path_check       _check) {
+        auto coll_inp = get_pep_input<collInp_t*>(_args);
+        if(published_filter_excludes(_rei, {coll_inp->collName}, _check)) {
+            return;
+        }
+
+        irods::publishing::publisher idx{_rei, config->instance_name_};
+        if(idx.publishing_metadata_exists_in_path(coll_inp->collName, _check)) {
+            THROW(
+                SYS_INVALID_OPR_TYPE,
+                boost::format("collection is published and now immutable [%s]")
+                % coll_inp->collName);
+        }
+    } // check_collection_is_mutable
+
+    void capture_publishing_metadata_state(
+        const std::string&     _rn,
+        ruleExecInfo_t*        _rei,
+        std::list<boost::any>& _args,
+        const path_check) {
+        const auto avu_inp = get_pep_input<modAVUMetadataInp_t*>(_args);
+        const std::string attribute{avu_inp->arg3};
+        if(config->publish != attribute) {
+            return;
+        }
+
+        const std::string operation{avu_inp->arg0};
+        const std::string type{avu_inp->arg1};
+        const std::string object_path{avu_inp->arg2};
+        const std::string rm{"rm"};
+        const std::string collection{"-C"};
+        const std::string object{"-d"};
+
+        // added ahead of the catalog so no write slips past the filter while
+        // the tag is being applied, and again once it is in place in case a
+        // rebuild scanned the catalog in between
+        if(operation != rm && published_paths) {
+            published_paths->insert(object_path);
+        }
+
+        irods::publishing::publisher idx{_rei, config->instance_name_};
+        // was the added tag a publishing indicator?
+        // verify that this is not new metadata with a query and set a flag
+        if(type == collection) {
+            metadata_is_new = !idx.metadata_exists_on_collection(
+                                             object_path,
+                                             avu_inp->arg3,
+                                             avu_inp->arg4,
+                                             avu_inp->arg5);
+        }
+        else if(type == object) {
+            metadata_is_new = !idx.metadata_exists_on_object(
+                                             object_path,
+                                             avu_inp->arg3,
+                                             avu_inp->arg4,
+                                             avu_inp->arg5);
+        }
+
+        if(operation == rm && !user_has_administrative_privileges(_rei)) {
+            THROW(
+                SYS_INVALID_OPR_TYPE,
+                boost::format("publishing metadata tags are immutable [%s]")
+                % object_path);
+        }
+    } // capture_publishing_metadata_state
+
+    void schedule_publishing_for_metadata(
+        const std::string&     _rn,
+        ruleExecInfo_t*        _rei,
+        std::list<boost::any>& _args,
+        const path_check) {
+        const auto avu_inp = get_pep_input<modAVUMetadataInp_t*>(_args);
+        const std::string operation{avu_inp->arg0};
+        const std::string type{avu_inp->arg1};
+        const std::string logical_path{avu_inp->arg2};
+        const std::string attribute{avu_inp->arg3};
+        const std::string value{avu_inp->arg4};
+        const std::string units{avu_inp->arg5};
+        const std::string add{"add"};
+        const std::string set{"set"};
+        const std::string rm{"rm"};
+        const std::string collection{"-C"};
+        const std::string data_object{"-d"};
+
+        // no work to do if this is not a publication attribute
+        if(config->publish != attribute) {
+            return;
+        }
+
+        if(published_paths && (operation == set || operation == add)) {
+            published_paths->insert(logical_path);
+        }
+
+        irods::publishing::publisher idx{_rei, config->instance_name_};
+        if(operation == rm) {
+            // stop any publication still running before the purge is queued
+            if(jobs) {
+                const auto cancelled = jobs->cancel(logical_path);
+                if(cancelled > 0) {
+                    rodsLog(
+                        config->log_level,
+                        "irods::publishing cancelled [%zu] running jobs for [%s]",
+                        cancelled,
+                        logical_path.c_str());
                 }
+            }
 
-                irods::publishing::publisher idx{_rei, config->instance_name_};
-                if(operation == rm) {
-                    // removed publish metadata from collection
-                    if(type == collection) {
-                        // schedule a purge of all published data in collection
-                    }
-                    // removed a single published AVU on an object
-                    if(type == data_object) {
-                        // schedule a purge of published data
-                    }
+            // removed publish metadata from collection
+            if(type == collection) {
+                idx.schedule_collection_purging_event(
+                    logical_path,
+                    value,
+                    _rei->rsComm->clientUser.userName);
+            }
+            // removed a single published AVU on an object
+            if(type == data_object) {
+                idx.schedule_object_purging_event(
+                        logical_path,
+                        _rei->rsComm->clientUser.userName,
+                        value);
+            }
+        }
+        else if(operation == set || operation == add) {
+            if(type == collection) {
+                if(metadata_is_new) {
+                    idx.schedule_collection_publishing_event(
+                        logical_path,
+                        value,
+                        _rei->rsComm->clientUser.userName);
                 }
-                else if(operation == set || operation == add) {
-                    if(type == collection) {
-                        if(metadata_is_new) {
-                            idx.schedule_collection_publishing_event(
-                                logical_path,
-                                value,
-                                _rei->rsComm->clientUser.userName);
-                        }
-                    }
-                    if(type == data_object) {
-                        if(metadata_is_new) {
-                            idx.schedule_object_publishing_event(
-                                    logical_path,
-                                    value,
-                                    _rei->rsComm->clientUser.userName);
-                        }
-                    }
+                else {
+                    // reapplying the tag brings the published dataset up to date
+                    idx.schedule_collection_reconcile_event(
+                        logical_path,
+                        value,
+                        _rei->rsComm->clientUser.userName);
+                }
+            }
+            if(type == data_object) {
+                if(metadata_is_new) {
+                    idx.schedule_object_publishing_event(
+                            logical_path,
+                            _rei->rsComm->clientUser.userName,
+                            value);
                 }
             }
         }
+    } // schedule_publishing_for_metadata
+
+    using pep_handler = void (*)(const std::string&, ruleExecInfo_t*, std::list<boost::any>&, path_check);
+
+    // each pep with the least of its target which must be looked up, decided
+    // by what the operation can do to a path.  a handler departs from it only
+    // on what the input shows: a read only open needs no check at all, and a
+    // forced overwrite must look at the existing object as well
+    struct pep_policy {
+        pep_handler handler;
+        path_check  check;
+    }; // struct pep_policy
+
+    using pep_table = irods::publishing::static_dispatch_table<pep_policy, 13>;
+
+    constexpr pep_table peps{{{
+        {"pep_api_data_obj_open_pre",     {check_opened_object_is_mutable,    path_check::object_and_ancestors}},
+        {"pep_api_data_obj_create_pre",   {check_data_object_is_mutable,      path_check::parent_only}},
+        {"pep_api_data_obj_put_pre",      {check_data_object_is_mutable,      path_check::parent_only}},
+        {"pep_api_data_obj_unlink_pre",   {check_data_object_is_mutable,      path_check::object_and_ancestors}},
+        {"pep_api_rm_coll_pre",           {check_collection_is_mutable,       path_check::object_and_ancestors}},
+        {"pep_api_replica_open_pre",      {check_opened_object_is_mutable,    path_check::object_and_ancestors}},
+        {"pep_api_bulk_data_obj_put_pre", {check_bulk_put_is_mutable,         path_check::parent_only}},
+        {"pep_api_data_obj_rename_pre",   {check_rename_is_mutable,           path_check::object_and_ancestors}},
+        {"pep_api_data_obj_copy_pre",     {check_copy_destination_is_mutable, path_check::parent_only}},
+        {"pep_api_data_obj_repl_pre",     {check_data_object_is_mutable,      path_check::object_and_ancestors}},
+        {"pep_api_phy_path_reg_pre",      {check_data_object_is_mutable,      path_check::parent_only}},
+        {"pep_api_mod_avu_metadata_pre",  {capture_publishing_metadata_state, path_check::none}},
+        {"pep_api_mod_avu_metadata_post", {schedule_publishing_for_metadata,  path_check::none}}}}};
+
+    static_assert(peps.entries().size() <= irods::publishing::pep_metrics::maximum_peps,
+                  "pep_metrics must have a histogram for every pep");
+
+    std::unique_ptr<irods::publishing::pep_metrics> metrics;
+
+    void apply_publishing_policy(
+        const std::string &    _rn,
+        ruleExecInfo_t*        _rei,
+        std::list<boost::any>& _args) {
+        const auto index = peps.index_of(_rn);
+        if(peps.entries().size() == index) {
+            return;
+        }
+
+        // recorded on every exit, immutability violations are reported by throwing
+        const irods::publishing::pep_timer timer{metrics.get(), index};
+        try {
+            const auto& policy = peps.entries()[index].value;
+            policy.handler(_rn, _rei, _args, policy.check);
+        }
         catch(const boost::bad_any_cast& _e) {
             THROW(
                 INVALID_ANY_CAST,
@@ -248,13 +510,31 @@ namespace {
     } // apply_publishing_policy
 
     void apply_object_policy(
-        ruleExecInfo_t*    _rei,
-        const std::string& _policy_root,
-        const std::string& _object_path,
-        const std::string& _user_name,
-        const std::string& _publisher,
-        const std::string& _publish_type) {
-        const std::string policy_name{irods::publishing::policy::compose_policy_name(
+        ruleExecInfo_t*                       _rei,
+        const std::string&                    _policy_root,
+        const std::string&                    _object_path,
+        const std::string&                    _user_name,
+        const std::string&                    _publisher,
+        const std::string&                    _publish_type,
+        irods::publishing::pipeline_metrics* _metrics = nullptr,
+        irods::publishing::cancellation_check _cancelled = {},
+        irods::publishing::publication_results* _results = nullptr) {
+        namespace pub = irods::publishing;
+
+        // call a native backend directly when one is loaded for this service
+        if(auto* be = pub::backend_registry::instance().find(_publisher)) {
+            const pub::job job{_rei, _object_path, _user_name, _publish_type, _metrics, std::move(_cancelled), _results};
+            if(pub::policy::object::publish == _policy_root) {
+                be->publish_object(job);
+            }
+            else {
+                be->purge_object(job);
+            }
+
+            return;
+        }
+
+        const std::string policy_name{pub::policy::compose_policy_name(
                               _policy_root,
                               _publisher)};
 
@@ -262,18 +542,38 @@ namespace {
         args.push_back(boost::any(_object_path));
         args.push_back(boost::any(_user_name));
         args.push_back(boost::any(_publish_type));
-        irods::publishing::invoke_policy(_rei, policy_name, args);
+        pub::invoke_policy(_rei, policy_name, args);
 
     } // apply_object_policy
 
     void apply_collection_policy(
-        ruleExecInfo_t*    _rei,
-        const std::string& _policy_root,
-        const std::string& _collection_name,
-        const std::string& _user_name,
-        const std::string& _publisher,
-        const std::string& _publish_type) {
-        const std::string policy_name{irods::publishing::policy::compose_policy_name(
+        ruleExecInfo_t*                       _rei,
+        const std::string&                    _policy_root,
+        const std::string&                    _collection_name,
+        const std::string&                    _user_name,
+        const std::string&                    _publisher,
+        const std::string&                    _publish_type,
+        irods::publishing::pipeline_metrics* _metrics = nullptr,
+        irods::publishing::cancellation_check _cancelled = {},
+        irods::publishing::publication_results* _results = nullptr) {
+        namespace pub = irods::publishing;
+
+        if(auto* be = pub::backend_registry::instance().find(_publisher)) {
+            const pub::job job{_rei, _collection_name, _user_name, _publish_type, _metrics, std::move(_cancelled), _results};
+            if(pub::policy::collection::publish == _policy_root) {
+                be->publish_collection(job);
+            }
+            else if(pub::policy::collection::reconcile == _policy_root) {
+                be->reconcile_collection(job);
+            }
+            else {
+                be->purge_collection(job);
+            }
+
+            return;
+        }
+
+        const std::string policy_name{pub::policy::compose_policy_name(
                               _policy_root,
                               _publisher)};
 
@@ -281,24 +581,409 @@ namespace {
         args.push_back(boost::any(_collection_name));
         args.push_back(boost::any(_user_name));
         args.push_back(boost::any(_publish_type));
-        irods::publishing::invoke_policy(_rei, policy_name, args);
+        pub::invoke_policy(_rei, policy_name, args);
 
     } // apply_collection_policy
 
+    // log, annotate and export the timing of a completed publication job
+    void report_job_metrics(
+        ruleExecInfo_t*                       _rei,
+        const std::string&                    _path,
+        const bool                            _is_collection,
+        irods::publishing::pipeline_metrics& _job_metrics) {
+        _job_metrics.complete();
+        auto summary = _job_metrics.to_json();
+        summary["path"] = _path;
+        const auto text = summary.dump();
+
+        rodsLog(
+            LOG_NOTICE,
+            "irods::publishing::job_metrics %s",
+            text.c_str());
+
+        if(metrics) {
+            metrics->record_job(_job_metrics);
+            metrics->export_if_due();
+        }
+
+        modAVUMetadataInp_t inp{};
+        inp.arg0 = "set";
+        inp.arg1 = const_cast<char*>(_is_collection ? "-C" : "-d");
+        inp.arg2 = const_cast<char*>(_path.c_str());
+        inp.arg3 = const_cast<char*>(config->job_metrics.c_str());
+        inp.arg4 = const_cast<char*>(text.c_str());
+        inp.arg5 = "";
+        const auto status = rsModAVUMetadata(_rei->rsComm, &inp);
+        if(status < 0) {
+            rodsLog(
+                LOG_ERROR,
+                "failed to annotate [%s] with job metrics [%d]",
+                _path.c_str(),
+                status);
+        }
+    } // report_job_metrics
+
+    // a backend which skips the objects it fails to publish counts them in
+    // the job metrics, the job then fails rather than reading as completed
+    void throw_if_objects_failed(
+        const std::string&                         _path,
+        const irods::publishing::pipeline_metrics& _job_metrics) {
+        if(_job_metrics.failures() > 0) {
+            THROW(
+                SYS_INTERNAL_ERR,
+                boost::format("[%u] objects of [%s] failed to publish")
+                % _job_metrics.failures()
+                % _path);
+        }
+    } // throw_if_objects_failed
+
+    // run a publication with somewhere to record the outcome of each path it
+    // publishes.  whatever was recorded is written out however the
+    // publication ends, unless it was cancelled and is about to be purged
+    template<typename Function>
+    void record_publication_results(
+        ruleExecInfo_t*                              _rei,
+        const irods::publishing::cancellation_check& _cancelled,
+        Function                                     _publish) {
+        std::unique_ptr<irods::publishing::publication_results> results;
+        if(boost::iequals(config->record_results, "true")) {
+            std::size_t batch_size{1000};
+            try {
+                batch_size = boost::lexical_cast<std::size_t>(config->result_batch_size);
+            }
+            catch(const boost::bad_lexical_cast&) {
+            }
+
+            results = std::make_unique<irods::publishing::publication_results>(
+                          config->result_prefix,
+                          batch_size);
+        }
+
+        const auto flush = [&] {
+            if(results && !irods::publishing::cancellation_requested(_cancelled)) {
+                results->flush(*_rei->rsComm);
+            }
+        };
+
+        try {
+            _publish(results.get());
+        }
+        catch(...) {
+            flush();
+            throw;
+        }
+
+        flush();
+    } // record_publication_results
+
+    uint64_t tagged_at(const nlohmann::json& _rule_obj) {
+        return _rule_obj.value("tagged-at", uint64_t{0});
+    } // tagged_at
+
+    // admit a job into its priority lane, requeueing it when the lane is saturated
+    std::unique_ptr<irods::publishing::job_slot> admit_to_lane(
+        ruleExecInfo_t*       _rei,
+        const nlohmann::json& _rule_obj) {
+        const std::string lane = _rule_obj.value("lane", irods::publishing::lane::small);
+
+        irods::publishing::publisher pub{_rei, config->instance_name_};
+        auto slot = std::make_unique<irods::publishing::job_slot>(
+                        lane,
+                        pub.lane_maximum_concurrency(lane));
+        if(slot->acquired()) {
+            return slot;
+        }
+
+        rodsLog(
+            config->log_level,
+            "irods::publishing lane [%s] is saturated, requeueing [%s]",
+            lane.c_str(),
+            _rule_obj.dump().c_str());
+
+        pub.schedule_publishing_policy(
+            _rule_obj.dump(),
+            pub.generate_delay_execution_parameters(lane));
+
+        return nullptr;
+    } // admit_to_lane
+
+    // run a job taken from the delay queue, recording its progress and
+    // outcome in the job table for the status request
+    template<typename Function>
+    void run_tracked_job(
+        const nlohmann::json& _rule_obj,
+        const std::string&    _path,
+        Function              _job) {
+        irods::publishing::job_table::handle tracked;
+        if(jobs) {
+            tracked = jobs->start(
+                          _rule_obj["rule-engine-operation"],
+                          _path,
+                          _rule_obj.value("publisher", ""),
+                          _rule_obj.value("user-name", ""),
+                          _rule_obj.value("estimated-size", uintmax_t{0}),
+                          _rule_obj.value("estimated-object-count", uintmax_t{0}));
+        }
+
+        try {
+            _job(tracked);
+        }
+        catch(const irods::exception& _e) {
+            tracked.fail(_e.code(), _e.client_display_what());
+            throw;
+        }
+
+        tracked.complete();
+    } // run_tracked_job
+
+    // a cancelled job stops with its dataset partially published.  purge it
+    // here rather than leave an incomplete dataset until a purge event runs,
+    // and remove the tag so the path no longer reads as published
+    bool purge_if_cancelled(
+        ruleExecInfo_t*                       _rei,
+        const nlohmann::json&                 _rule_obj,
+        const bool                            _is_collection,
+        irods::publishing::job_table::handle& _tracked) {
+        namespace pub = irods::publishing;
+        if(!_tracked.cancel_requested()) {
+            return false;
+        }
+
+        const std::string path = _rule_obj[_is_collection ? "collection-name" : "object-path"];
+        rodsLog(
+            config->log_level,
+            "irods::publishing job for [%s] cancelled, purging",
+            path.c_str());
+
+        if(_is_collection) {
+            apply_collection_policy(
+                _rei,
+                pub::policy::collection::purge,
+                path,
+                _rule_obj["user-name"],
+                _rule_obj["publisher"],
+                _rule_obj["publish-type"]);
+
+            pub::collection_fingerprint fp{_rei->rsComm, config->fingerprint};
+            fp.invalidate(path);
+        }
+        else {
+            apply_object_policy(
+                _rei,
+                pub::policy::object::purge,
+                path,
+                _rule_obj["user-name"],
+                _rule_obj["publisher"],
+                _rule_obj["publish-type"]);
+        }
+
+        // the tag is already gone when its removal cancelled the job
+        const std::string publisher = _rule_obj["publisher"];
+        modAVUMetadataInp_t inp{};
+        inp.arg0 = "rmw";
+        inp.arg1 = const_cast<char*>(_is_collection ? "-C" : "-d");
+        inp.arg2 = const_cast<char*>(path.c_str());
+        inp.arg3 = const_cast<char*>(config->publish.c_str());
+        inp.arg4 = const_cast<char*>(publisher.c_str());
+        inp.arg5 = "%";
+        const auto status = rsModAVUMetadata(_rei->rsComm, &inp);
+        if(status < 0 && CAT_SUCCESS_BUT_WITH_NO_INFO != status) {
+            rodsLog(
+                LOG_ERROR,
+                "failed to remove the publishing tag of cancelled [%s] [%d]",
+                path.c_str(),
+                status);
+        }
+
+        _tracked.mark_cancelled();
+        return true;
+    } // purge_if_cancelled
+
+    // a cancelled reconciliation stops where it is.  the published copy was
+    // complete before it began and is left in place, the backend has already
+    // dropped the fingerprint so the next reconciliation compares everything
+    bool stop_if_cancelled(
+        irods::publishing::job_table::handle& _tracked) {
+        if(!_tracked.cancel_requested()) {
+            return false;
+        }
+
+        _tracked.mark_cancelled();
+        return true;
+    } // stop_if_cancelled
+
+    // the publication jobs waiting in the delay queue, running on this host,
+    // and those which most recently completed or failed
+    nlohmann::json publishing_status(ruleExecInfo_t* _rei) {
+        namespace pub = irods::publishing;
+        using json = nlohmann::json;
+        constexpr std::size_t maximum_listed_queued_jobs = 256;
+
+        const auto seconds = [](const uint64_t _micros) {
+            return static_cast<double>(_micros) / 1e6;
+        };
+
+        pub::genquery_catalog catalog{_rei->rsComm};
+        json queued = json::array();
+        for(const auto& r : catalog.list_delayed_rules(pub::policy::prefix, maximum_listed_queued_jobs)) {
+            json entry{{"id", r.id}};
+            try {
+                entry["scheduled-for"] = boost::lexical_cast<uint64_t>(r.exec_time);
+            }
+            catch(const boost::bad_lexical_cast&) {
+                entry["scheduled-for"] = r.exec_time;
+            }
+
+            // the rule text is the json scheduled by the publisher
+            const auto start = r.name.find('{');
+            const auto rule_obj = std::string::npos == start ?
+                                  json{} :
+                                  json::parse(r.name.substr(start), nullptr, false);
+            if(rule_obj.is_object()) {
+                for(const auto* key : {"rule-engine-operation", "object-path", "collection-name",
+                                       "publisher", "user-name", "lane", "estimated-size",
+                                       "estimated-object-count", "tagged-at"}) {
+                    if(rule_obj.contains(key)) {
+                        entry[key] = rule_obj[key];
+                    }
+                }
+            }
+            else {
+                entry["rule-text"] = r.name;
+            }
+
+            queued.push_back(std::move(entry));
+        }
+
+        json running   = json::array();
+        json failed    = json::array();
+        json cancelled = json::array();
+        json completed = json::array();
+        const auto now = pub::pipeline_metrics::now();
+        for(const auto& j : jobs ? jobs->jobs() : std::vector<pub::job_table::job>{}) {
+            const bool is_running = pub::job_table::state::running == j.status;
+            const auto elapsed    = (is_running ? now : j.updated_at) - j.started_at;
+            const auto rate       = elapsed > 0 ? static_cast<double>(j.bytes_done) / seconds(elapsed) : 0.0;
+
+            json entry{
+                {"rule-engine-operation",  j.operation},
+                {"path",                   j.path},
+                {"publisher",              j.publisher},
+                {"user-name",              j.user},
+                {"pid",                    j.pid},
+                {"started-at",             j.started_at},
+                {"updated-at",             j.updated_at},
+                {"elapsed-seconds",        seconds(elapsed)},
+                {"bytes-total",            j.bytes_total},
+                {"bytes-done",             j.bytes_done},
+                {"objects-total",          j.objects_total},
+                {"objects-done",           j.objects_done},
+                {"bytes-per-second",       rate}};
+
+            if(is_running) {
+                // the totals are estimates taken when the job was queued
+                if(rate > 0.0 && j.bytes_total > j.bytes_done) {
+                    entry["eta-seconds"] = static_cast<double>(j.bytes_total - j.bytes_done) / rate;
+                }
+                else if(j.objects_done > 0 && j.objects_total > j.objects_done) {
+                    entry["eta-seconds"] = seconds(elapsed) / j.objects_done *
+                                           (j.objects_total - j.objects_done);
+                }
+                else {
+                    entry["eta-seconds"] = nullptr;
+                }
+                entry["cancel-requested"] = j.cancel_requested;
+                running.push_back(std::move(entry));
+            }
+            else if(pub::job_table::state::failed == j.status) {
+                entry["error"]   = j.error;
+                entry["message"] = j.message;
+                failed.push_back(std::move(entry));
+            }
+            else if(pub::job_table::state::cancelled == j.status) {
+                cancelled.push_back(std::move(entry));
+            }
+            else {
+                completed.push_back(std::move(entry));
+            }
+        }
+
+        return json{
+            {"queued",    {{"count", catalog.count_delayed_rules(pub::policy::prefix)},
+                           {"jobs",  std::move(queued)}}},
+            {"running",   std::move(running)},
+            {"failed",    std::move(failed)},
+            {"cancelled", std::move(cancelled)},
+            {"completed", std::move(completed)}};
+    } // publishing_status
+
 } // namespace
 
 
 irods::error start(
     irods::default_re_ctx&,
     const std::string& _instance_name ) {
-    RuleExistsHelper::Instance()->registerRuleRegex("pep_api_.*");
+    // only advertise the peps we implement rather than all of pep_api_.*
+    std::string pep_regex;
+    for(const auto& e : peps.entries()) {
+        pep_regex += (pep_regex.empty() ? "" : "|") + std::string{e.key};
+    }
+    RuleExistsHelper::Instance()->registerRuleRegex(pep_regex);
     config = std::make_unique<irods::publishing::configuration>(_instance_name);
+    jobs   = std::make_unique<irods::publishing::job_table>(_instance_name);
+
+    // the filter is built by the first check which finds it stale, start
+    // has no connection with which to scan the catalog
+    try {
+        published_filter_refresh_interval = boost::lexical_cast<uint64_t>(config->published_filter_refresh_interval);
+    }
+    catch(const boost::bad_lexical_cast&) {
+        published_filter_refresh_interval = 0;
+        rodsLog(
+            LOG_ERROR,
+            "invalid published_filter_refresh_interval [%s], using [%llu]",
+            config->published_filter_refresh_interval.c_str(),
+            static_cast<unsigned long long>(published_filter_refresh_interval));
+    }
+
+    if(published_filter_refresh_interval > 0) {
+        published_paths = std::make_unique<irods::publishing::published_path_filter>(_instance_name);
+    }
+
+    if(!config->metrics_file.empty()) {
+        std::vector<std::string> pep_names;
+        for(const auto& e : peps.entries()) {
+            pep_names.emplace_back(e.key);
+        }
+
+        int interval{10};
+        try {
+            interval = boost::lexical_cast<int>(config->metrics_export_interval);
+        }
+        catch(const boost::bad_lexical_cast&) {
+            rodsLog(
+                LOG_ERROR,
+                "invalid metrics_export_interval [%s], using [%d]",
+                config->metrics_export_interval.c_str(),
+                interval);
+        }
+
+        metrics = std::make_unique<irods::publishing::pep_metrics>(
+                      pep_names,
+                      config->metrics_file,
+                      interval);
+    }
+
     return SUCCESS();
 } // start
 
 irods::error stop(
     irods::default_re_ctx&,
     const std::string& ) {
+    metrics.reset();
+    published_paths.reset();
+    jobs.reset();
+    irods::publishing::backend_registry::instance().clear_resolved();
     return SUCCESS();
 } // stop
 
@@ -306,15 +991,7 @@ irods::error rule_exists(
     irods::default_re_ctx&,
     const std::string& _rn,
     bool&              _ret) {
-    const std::set<std::string> rules{
-                                    "pep_api_rm_coll_pre",
-                                    "pep_api_data_obj_open_pre",
-                                    "pep_api_data_obj_create_pre",
-                                    "pep_api_data_obj_put_pre",
-                                    "pep_api_data_obj_unlink_pre",
-                                    "pep_api_mod_avu_metadata_pre",
-                                    "pep_api_mod_avu_metadata_post"};
-    _ret = rules.find(_rn) != rules.end();
+    _ret = nullptr != peps.find(_rn);
 
     return SUCCESS();
 } // rule_exists
@@ -387,6 +1064,53 @@ irods::error exec_rule_text(
                     SYS_NOT_SUPPORTED,
                     "instance name not found");
         }
+
+        const std::string operation = rule_obj.value("rule-engine-operation", "");
+        if(irods::publishing::policy::status == operation ||
+           irods::publishing::policy::cancel == operation) {
+            ruleExecInfo_t* rei{};
+            const auto err = _eff_hdlr("unsafe_ms_ctx", &rei);
+            if(!err.ok()) {
+                return err;
+            }
+
+            if(!user_has_administrative_privileges(rei)) {
+                return ERROR(
+                        SYS_NO_API_PRIV,
+                        boost::str(boost::format("[%s] requires administrative privileges")
+                        % operation));
+            }
+
+            std::string reply;
+            if(irods::publishing::policy::status == operation) {
+                reply = publishing_status(rei).dump();
+            }
+            else {
+                const std::string path = rule_obj.value("path", "");
+                if(path.empty()) {
+                    return ERROR(
+                            SYS_INVALID_INPUT_PARAM,
+                            "cancellation requires a path");
+                }
+
+                const auto cancelled = jobs ? jobs->cancel(path) : 0;
+                rodsLog(
+                    config->log_level,
+                    "irods::publishing [%s] cancelled [%zu] running jobs for [%s]",
+                    rei->rsComm->clientUser.userName,
+                    cancelled,
+                    path.c_str());
+                reply = json{{"path", path}, {"cancelled", cancelled}}.dump();
+            }
+
+            _writeString(
+                const_cast<char*>("stdout"),
+                const_cast<char*>(reply.c_str()),
+                rei);
+
+            return SUCCESS();
+        }
+
         return ERROR(
                 SYS_NOT_SUPPORTED,
                 "supported rule name not found");
@@ -438,13 +1162,42 @@ irods::error exec_rule_expression(
                     user_name.c_str(),
                     NAME_LEN);
 
-                apply_object_policy(
-                    rei,
-                    irods::publishing::policy::object::publish,
-                    rule_obj["object-path"],
-                    rule_obj["user-name"],
-                    rule_obj["publisher"],
-                    rule_obj["publish-type"]);
+                const auto slot = admit_to_lane(rei, rule_obj);
+                if(!slot) {
+                    return SUCCESS();
+                }
+
+                run_tracked_job(rule_obj, rule_obj["object-path"], [&](auto& _tracked) {
+                    irods::publishing::pipeline_metrics job_metrics{tagged_at(rule_obj)};
+                    job_metrics.on_upload([&_tracked](const uintmax_t _bytes) { _tracked.progress(_bytes); });
+                    const irods::publishing::cancellation_check cancelled{[&_tracked] { return _tracked.cancel_requested(); }};
+                    try {
+                        record_publication_results(rei, cancelled, [&](auto* _results) {
+                            apply_object_policy(
+                                rei,
+                                irods::publishing::policy::object::publish,
+                                rule_obj["object-path"],
+                                rule_obj["user-name"],
+                                rule_obj["publisher"],
+                                rule_obj["publish-type"],
+                                &job_metrics,
+                                cancelled,
+                                _results);
+                        });
+                    }
+                    catch(const irods::exception&) {
+                        // what a failed job published still counts toward the totals
+                        report_job_metrics(rei, rule_obj["object-path"], false, job_metrics);
+                        throw;
+                    }
+
+                    if(purge_if_cancelled(rei, rule_obj, false, _tracked)) {
+                        return;
+                    }
+
+                    report_job_metrics(rei, rule_obj["object-path"], false, job_metrics);
+                    throw_if_objects_failed(rule_obj["object-path"], job_metrics);
+                });
             }
             catch(const irods::exception& _e) {
                 printErrorStack(&rei->rsComm->rError);
@@ -463,13 +1216,15 @@ irods::error exec_rule_expression(
                     user_name.c_str(),
                     NAME_LEN);
 
-                apply_object_policy(
-                    rei,
-                    irods::publishing::policy::object::purge,
-                    rule_obj["object-path"],
-                    rule_obj["user-name"],
-                    rule_obj["publisher"],
-                    rule_obj["publish-type"]);
+                run_tracked_job(rule_obj, rule_obj["object-path"], [&](auto&) {
+                    apply_object_policy(
+                        rei,
+                        irods::publishing::policy::object::purge,
+                        rule_obj["object-path"],
+                        rule_obj["user-name"],
+                        rule_obj["publisher"],
+                        rule_obj["publish-type"]);
+                });
             }
             catch(const irods::exception& _e) {
                 printErrorStack(&rei->rsComm->rError);
@@ -481,24 +1236,103 @@ irods::error exec_rule_expression(
         else if(irods::publishing::policy::collection::publish ==
                 rule_obj["rule-engine-operation"]) {
 
-            apply_collection_policy(
-                rei,
-                irods::publishing::policy::collection::publish,
-                rule_obj["collection-name"],
-                rule_obj["user-name"],
-                rule_obj["publisher"],
-                rule_obj["publish-type"]);
+            const auto slot = admit_to_lane(rei, rule_obj);
+            if(!slot) {
+                return SUCCESS();
+            }
+
+            run_tracked_job(rule_obj, rule_obj["collection-name"], [&](auto& _tracked) {
+                irods::publishing::pipeline_metrics job_metrics{tagged_at(rule_obj)};
+                job_metrics.on_upload([&_tracked](const uintmax_t _bytes) { _tracked.progress(_bytes); });
+                const irods::publishing::cancellation_check cancelled{[&_tracked] { return _tracked.cancel_requested(); }};
+                try {
+                    record_publication_results(rei, cancelled, [&](auto* _results) {
+                        apply_collection_policy(
+                            rei,
+                            irods::publishing::policy::collection::publish,
+                            rule_obj["collection-name"],
+                            rule_obj["user-name"],
+                            rule_obj["publisher"],
+                            rule_obj["publish-type"],
+                            &job_metrics,
+                            cancelled,
+                            _results);
+                    });
+                }
+                catch(const irods::exception&) {
+                    // what a failed job published still counts toward the totals
+                    report_job_metrics(rei, rule_obj["collection-name"], true, job_metrics);
+                    throw;
+                }
+
+                if(purge_if_cancelled(rei, rule_obj, true, _tracked)) {
+                    return;
+                }
+
+                report_job_metrics(rei, rule_obj["collection-name"], true, job_metrics);
+                throw_if_objects_failed(rule_obj["collection-name"], job_metrics);
+
+                // seed the fingerprint so later reconciliations only visit what changed
+                irods::publishing::collection_fingerprint fp{rei->rsComm, config->fingerprint};
+                fp.update(rule_obj["collection-name"]);
+                fp.commit();
+            });
+        }
+        else if(irods::publishing::policy::collection::reconcile ==
+                rule_obj["rule-engine-operation"]) {
+
+            const auto slot = admit_to_lane(rei, rule_obj);
+            if(!slot) {
+                return SUCCESS();
+            }
+
+            run_tracked_job(rule_obj, rule_obj["collection-name"], [&](auto& _tracked) {
+                irods::publishing::pipeline_metrics job_metrics{tagged_at(rule_obj)};
+                job_metrics.on_upload([&_tracked](const uintmax_t _bytes) { _tracked.progress(_bytes); });
+                const irods::publishing::cancellation_check cancelled{[&_tracked] { return _tracked.cancel_requested(); }};
+                try {
+                    record_publication_results(rei, cancelled, [&](auto* _results) {
+                        apply_collection_policy(
+                            rei,
+                            irods::publishing::policy::collection::reconcile,
+                            rule_obj["collection-name"],
+                            rule_obj["user-name"],
+                            rule_obj["publisher"],
+                            rule_obj["publish-type"],
+                            &job_metrics,
+                            cancelled,
+                            _results);
+                    });
+                }
+                catch(const irods::exception&) {
+                    // what a failed job published still counts toward the totals
+                    report_job_metrics(rei, rule_obj["collection-name"], true, job_metrics);
+                    throw;
+                }
+
+                if(stop_if_cancelled(_tracked)) {
+                    return;
+                }
+
+                report_job_metrics(rei, rule_obj["collection-name"], true, job_metrics);
+                throw_if_objects_failed(rule_obj["collection-name"], job_metrics);
+            });
         }
         else if(irods::publishing::policy::collection::purge ==
                 rule_obj["rule-engine-operation"]) {
 
-            apply_collection_policy(
-                rei,
-                irods::publishing::policy::collection::purge,
-                rule_obj["collection-name"],
-                rule_obj["user-name"],
-                rule_obj["publisher"],
-                rule_obj["publish-type"]);
+            run_tracked_job(rule_obj, rule_obj["collection-name"], [&](auto&) {
+                apply_collection_policy(
+                    rei,
+                    irods::publishing::policy::collection::purge,
+                    rule_obj["collection-name"],
+                    rule_obj["user-name"],
+                    rule_obj["publisher"],
+                    rule_obj["publish-type"]);
+
+                irods::publishing::collection_fingerprint fp{rei->rsComm, config->fingerprint};
+                fp.invalidate(rule_obj["collection-name"]);
+            });
         }
         else {
             printErrorStack(&rei->rsComm->rError);
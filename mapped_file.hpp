@@ -0,0 +1,82 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <irods/irods_exception.hpp>
+#include <irods/rodsErrorTable.h>
+
+#include <boost/format.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace irods {
+    namespace publishing {
+        // a whole file mapped read only, so a replica in a local vault may be
+        // handed to the upload without first being copied into a buffer
+        class mapped_file {
+            public:
+            explicit mapped_file(const std::string& _path) {
+                const int fd = ::open(_path.c_str(), O_RDONLY);
+                if(fd < 0) {
+                    THROW(
+                        UNIX_FILE_OPEN_ERR - errno,
+                        boost::format("failed to open [%s]")
+                        % _path);
+                }
+
+                struct stat st{};
+                if(0 != ::fstat(fd, &st)) {
+                    const int error = errno;
+                    ::close(fd);
+                    THROW(
+                        UNIX_FILE_STAT_ERR - error,
+                        boost::format("failed to stat [%s]")
+                        % _path);
+                }
+
+                size_ = static_cast<std::size_t>(st.st_size);
+                if(size_ > 0) {
+                    void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if(MAP_FAILED == addr) {
+                        const int error = errno;
+                        ::close(fd);
+                        THROW(
+                            UNIX_FILE_READ_ERR - error,
+                            boost::format("failed to map [%s]")
+                            % _path);
+                    }
+
+                    // the upload walks the file once from start to end
+                    ::madvise(addr, size_, MADV_SEQUENTIAL);
+                    data_ = static_cast<const char*>(addr);
+                }
+
+                ::close(fd);
+            } // ctor
+
+            ~mapped_file() {
+                if(data_) {
+                    ::munmap(const_cast<char*>(data_), size_);
+                }
+            } // dtor
+
+            mapped_file(const mapped_file&) = delete;
+            mapped_file& operator=(const mapped_file&) = delete;
+
+            const char* data() const noexcept { return data_; }
+            std::size_t size() const noexcept { return size_; }
+
+            private:
+            const char* data_{};
+            std::size_t size_{};
+        }; // class mapped_file
+    } // namespace publishing
+} // namespace irods
+
+#endif // MAPPED_FILE_HPP
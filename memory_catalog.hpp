@@ -0,0 +1,194 @@
+#ifndef MEMORY_CATALOG_HPP
+#define MEMORY_CATALOG_HPP
+
+#include "catalog.hpp"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace irods {
+    namespace publishing {
+        // an in process catalog for unit tests and microbenchmarks, it counts
+        // each lookup as a query just as genquery_catalog would issue one
+        class memory_catalog : public catalog {
+        public:
+            void add_data_object(
+                const std::string& _object_path,
+                const uintmax_t    _size,
+                const std::size_t  _replicas = 1) {
+                objects_[_object_path] = std::make_pair(_size, _replicas);
+            } // add_data_object
+
+            void add_object_metadata(
+                const std::string& _object_path,
+                const std::string& _attribute,
+                const std::string& _value,
+                const std::string& _units = {}) {
+                object_metadata_[{_object_path, _attribute}].emplace_back(_value, _units);
+            } // add_object_metadata
+
+            void add_collection_metadata(
+                const std::string& _collection_name,
+                const std::string& _attribute,
+                const std::string& _value,
+                const std::string& _units = {}) {
+                collection_metadata_[{_collection_name, _attribute}].emplace_back(_value, _units);
+            } // add_collection_metadata
+
+            void add_user_metadata(
+                const std::string& _user_name,
+                const std::string& _attribute,
+                const std::string& _value) {
+                user_metadata_[{_user_name, _attribute}].push_back(_value);
+            } // add_user_metadata
+
+            void add_delayed_rule(const std::string& _rule_name) {
+                delayed_rules_.push_back(_rule_name);
+            } // add_delayed_rule
+
+            metadata_results object_metadata(
+                const std::string& _object_path,
+                const std::string& _attribute) override {
+                count_query();
+                return find(object_metadata_, _object_path, _attribute);
+            } // object_metadata
+
+            metadata_results collection_metadata(
+                const std::string& _collection_name,
+                const std::string& _attribute) override {
+                count_query();
+                return find(collection_metadata_, _collection_name, _attribute);
+            } // collection_metadata
+
+            std::vector<std::string> user_metadata(
+                const std::string& _user_name,
+                const std::string& _attribute) override {
+                count_query();
+                return find(user_metadata_, _user_name, _attribute);
+            } // user_metadata
+
+            std::vector<std::string> objects_with_metadata(
+                const std::string& _collection_name,
+                const std::string& _attribute) override {
+                count_query();
+                std::vector<std::string> paths;
+                for(const auto& m : object_metadata_) {
+                    if(_attribute == m.first.second &&
+                       !m.second.empty() &&
+                       parent_collection(m.first.first) == _collection_name) {
+                        paths.push_back(m.first.first);
+                    }
+                }
+                return paths;
+            } // objects_with_metadata
+
+            std::vector<std::string> paths_with_metadata(
+                const std::string& _attribute) override {
+                count_query();
+                std::vector<std::string> paths;
+                for(const auto* metadata : {&collection_metadata_, &object_metadata_}) {
+                    for(const auto& m : *metadata) {
+                        if(_attribute == m.first.second && !m.second.empty()) {
+                            paths.push_back(m.first.first);
+                        }
+                    }
+                }
+                return paths;
+            } // paths_with_metadata
+
+            bool is_data_object(const std::string& _path) override {
+                count_query();
+                return objects_.count(_path) > 0;
+            } // is_data_object
+
+            uintmax_t data_object_size(const std::string& _object_path) override {
+                count_query();
+                const auto it = objects_.find(_object_path);
+                return objects_.end() == it ? 0 : it->second.first;
+            } // data_object_size
+
+            job_size_estimate collection_size(const std::string& _collection_name) override {
+                count_query();
+                job_size_estimate estimate{};
+                for_each_beneath(_collection_name, true, [&](const auto& _object) {
+                    estimate.bytes   += _object.second.first * _object.second.second;
+                    estimate.objects += _object.second.second;
+                });
+                return estimate;
+            } // collection_size
+
+            std::vector<std::string> list_data_objects(
+                const std::string& _collection_name,
+                const bool         _recursive) override {
+                count_query();
+                std::vector<std::string> paths;
+                for_each_beneath(_collection_name, _recursive, [&](const auto& _object) {
+                    paths.push_back(_object.first);
+                });
+                return paths;
+            } // list_data_objects
+
+            uintmax_t count_delayed_rules(const std::string& _name_fragment) override {
+                count_query();
+                uintmax_t count{};
+                for(const auto& r : delayed_rules_) {
+                    if(std::string::npos != r.find(_name_fragment)) {
+                        ++count;
+                    }
+                }
+                return count;
+            } // count_delayed_rules
+
+            std::vector<delayed_rule> list_delayed_rules(
+                const std::string& _name_fragment,
+                const std::size_t  _limit) override {
+                count_query();
+                std::vector<delayed_rule> rules;
+                for(std::size_t i = 0; i < delayed_rules_.size() && rules.size() < _limit; ++i) {
+                    if(std::string::npos != delayed_rules_[i].find(_name_fragment)) {
+                        rules.push_back({std::to_string(i), delayed_rules_[i], {}});
+                    }
+                }
+                return rules;
+            } // list_delayed_rules
+
+        private:
+            using key = std::pair<std::string, std::string>;
+
+            template<typename Value>
+            static Value find(
+                const std::map<key, Value>& _map,
+                const std::string&          _name,
+                const std::string&          _attribute) {
+                const auto it = _map.find({_name, _attribute});
+                return _map.end() == it ? Value{} : it->second;
+            } // find
+
+            template<typename Function>
+            void for_each_beneath(
+                const std::string& _collection_name,
+                const bool         _recursive,
+                Function           _fn) const {
+                const std::string prefix{_collection_name + "/"};
+                for(auto it = objects_.lower_bound(prefix);
+                    it != objects_.end() && 0 == it->first.compare(0, prefix.size(), prefix);
+                    ++it) {
+                    if(_recursive || parent_collection(it->first) == _collection_name) {
+                        _fn(*it);
+                    }
+                }
+            } // for_each_beneath
+
+            // logical path to size and replica count
+            std::map<std::string, std::pair<uintmax_t, std::size_t>>   objects_;
+            std::map<key, metadata_results>                            object_metadata_;
+            std::map<key, metadata_results>                            collection_metadata_;
+            std::map<key, std::vector<std::string>>                    user_metadata_;
+            std::vector<std::string>                                   delayed_rules_;
+        }; // class memory_catalog
+    } // namespace publishing
+} // namespace irods
+
+#endif // MEMORY_CATALOG_HPP
@@ -0,0 +1,51 @@
+#include "metadata_operations.hpp"
+
+#include <irods/irods_exception.hpp>
+#include <irods/rs_atomic_apply_metadata_operations.hpp>
+
+#include <boost/format.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <cstdlib>
+#include <memory>
+
+namespace irods {
+    namespace publishing {
+        void apply_metadata_operations(
+            rsComm_t&                         _comm,
+            const std::string&                _path,
+            const bool                        _is_collection,
+            const std::vector<avu_operation>& _operations) {
+            if(_operations.empty()) {
+                return;
+            }
+
+            nlohmann::json operations = nlohmann::json::array();
+            for(const auto& o : _operations) {
+                operations.push_back({
+                    {"operation", o.operation},
+                    {"attribute", o.attribute},
+                    {"value",     o.value},
+                    {"units",     o.units}});
+            }
+
+            const nlohmann::json input{
+                {"entity_name", _path},
+                {"entity_type", _is_collection ? "collection" : "data_object"},
+                {"operations",  operations}};
+
+            char* output{};
+            const auto status = rs_atomic_apply_metadata_operations(&_comm, input.dump().c_str(), &output);
+            std::unique_ptr<char, decltype(&std::free)> output_guard{output, std::free};
+            if(status < 0) {
+                THROW(
+                    status,
+                    boost::format("failed to apply [%zu] metadata operations to [%s] [%s]")
+                    % _operations.size()
+                    % _path
+                    % (output ? output : ""));
+            }
+        } // apply_metadata_operations
+    } // namespace publishing
+} // namespace irods
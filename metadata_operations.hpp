@@ -0,0 +1,28 @@
+#ifndef METADATA_OPERATIONS_HPP
+#define METADATA_OPERATIONS_HPP
+
+#include <irods/rcConnect.h>
+
+#include <string>
+#include <vector>
+
+namespace irods {
+    namespace publishing {
+        struct avu_operation {
+            std::string operation; // add or remove
+            std::string attribute;
+            std::string value;
+            std::string units;
+        }; // struct avu_operation
+
+        // apply _operations to the metadata of _path in a single catalog
+        // transaction, all of them or none
+        void apply_metadata_operations(
+            rsComm_t&                         _comm,
+            const std::string&                _path,
+            const bool                        _is_collection,
+            const std::vector<avu_operation>& _operations);
+    } // namespace publishing
+} // namespace irods
+
+#endif // METADATA_OPERATIONS_HPP
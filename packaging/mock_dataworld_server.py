@@ -0,0 +1,236 @@
+"""A local stand-in for the parts of the data.world API used by the dataworld
+publishing plugin, with configurable latency, bandwidth and error injection.
+
+    POST   /v0/datasets/<user>
+    GET    /v0/datasets/<user>/<id>
+    DELETE /v0/datasets/<user>/<id>
+    DELETE /v0/datasets/<user>/<id>/files/<name>
+    PUT    /v0/uploads/<user>/<id>/files/<name>
+
+and of a persistent identifier minting service:
+
+    POST   /pids    {"count": n} -> {"pids": [...]}
+
+Run standalone with `python mock_dataworld_server.py --port 8080`, or use
+`running_server()` from a test.
+"""
+
+import argparse
+import contextlib
+import json
+import random
+import re
+import threading
+import time
+
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import unquote
+
+
+class Settings(object):
+    def __init__(self, latency=0.0, bandwidth=0, error_rate=0.0, seed=None):
+        # seconds added to every request
+        self.latency = latency
+        # bytes per second for request bodies, 0 is unlimited
+        self.bandwidth = bandwidth
+        # fraction of requests answered with a 500
+        self.error_rate = error_rate
+        self.random = random.Random(seed)
+
+
+class State(object):
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.next_id = 0
+        # (user, id) -> {'title': str, 'files': {name: size}}
+        self.datasets = {}
+        # one entry per completed upload: (start, end, bytes)
+        self.uploads = []
+        # the file name of each upload
+        self.uploaded_names = []
+        # (method, path, status, seconds)
+        self.requests = []
+        self.next_pid = 0
+        # the size of each minting request
+        self.pid_requests = []
+
+    def create_dataset(self, user, title):
+        with self.lock:
+            self.next_id += 1
+            dataset_id = 'dataset-{0}'.format(self.next_id)
+            self.datasets[(user, dataset_id)] = {'title': title, 'files': {}}
+            return dataset_id
+
+    def mint_pids(self, count):
+        with self.lock:
+            first = self.next_pid
+            self.next_pid += count
+            self.pid_requests.append(count)
+            return ['21.T12345/mock-{0}'.format(n) for n in range(first, first + count)]
+
+    def file_count(self):
+        with self.lock:
+            return sum(len(d['files']) for d in self.datasets.values())
+
+
+DATASETS = re.compile(r'^/v0/datasets/([^/]+)/?$')
+DATASET = re.compile(r'^/v0/datasets/([^/]+)/([^/]+)/?$')
+DATASET_FILE = re.compile(r'^/v0/datasets/([^/]+)/([^/]+)/files/(.+)$')
+UPLOAD = re.compile(r'^/v0/uploads/([^/]+)/([^/]+)/files/(.+)$')
+PIDS = re.compile(r'^/pids/?$')
+
+
+def make_handler(settings, state):
+    class Handler(BaseHTTPRequestHandler):
+        protocol_version = 'HTTP/1.1'
+
+        def log_message(self, format, *args):
+            pass
+
+        def read_body(self):
+            remaining = int(self.headers.get('Content-Length', 0))
+            chunks = []
+            chunk_size = 64 * 1024
+            while remaining > 0:
+                started = time.time()
+                chunk = self.rfile.read(min(chunk_size, remaining))
+                if not chunk:
+                    break
+                chunks.append(chunk)
+                remaining -= len(chunk)
+                if settings.bandwidth > 0:
+                    wait = len(chunk) / float(settings.bandwidth) - (time.time() - started)
+                    if wait > 0:
+                        time.sleep(wait)
+            return b''.join(chunks)
+
+        def reply(self, status, body=None):
+            payload = json.dumps(body if body is not None else {}).encode('utf-8')
+            self.send_response(status)
+            self.send_header('Content-Type', 'application/json')
+            self.send_header('Content-Length', str(len(payload)))
+            self.end_headers()
+            self.wfile.write(payload)
+            return status
+
+        def handle_request(self, method):
+            started = time.time()
+            body = self.read_body()
+            if settings.latency > 0:
+                time.sleep(settings.latency)
+
+            path = unquote(self.path.split('?')[0])
+            if settings.error_rate > 0 and settings.random.random() < settings.error_rate:
+                status = self.reply(500, {'message': 'injected error'})
+            else:
+                status = self.dispatch(method, path, body, started)
+
+            with state.lock:
+                state.requests.append((method, path, status, time.time() - started))
+
+        def dispatch(self, method, path, body, started):
+            if 'POST' == method and PIDS.match(path):
+                count = int(json.loads(body.decode('utf-8') or '{}').get('count', 1))
+                return self.reply(200, {'pids': state.mint_pids(count)})
+
+            if 'POST' == method:
+                m = DATASETS.match(path)
+                if m:
+                    user = m.group(1)
+                    title = json.loads(body.decode('utf-8') or '{}').get('title', '')
+                    dataset_id = state.create_dataset(user, title)
+                    return self.reply(200, {'message': 'Dataset created successfully.',
+                                            'uri': 'https://data.world/{0}/{1}'.format(user, dataset_id)})
+
+            if 'PUT' == method:
+                m = UPLOAD.match(path)
+                if m:
+                    key = (m.group(1), m.group(2))
+                    with state.lock:
+                        if key not in state.datasets:
+                            return self.reply(404, {'message': 'dataset not found'})
+                        state.datasets[key]['files'][m.group(3)] = len(body)
+                        state.uploads.append((started, time.time(), len(body)))
+                        state.uploaded_names.append(m.group(3))
+                    return self.reply(200, {'message': 'File uploaded.'})
+
+            if 'GET' == method:
+                m = DATASET.match(path)
+                if m:
+                    with state.lock:
+                        dataset = state.datasets.get((m.group(1), m.group(2)))
+                        if dataset is None:
+                            return self.reply(404, {'message': 'dataset not found'})
+                        files = [{'name': n, 'sizeInBytes': s} for n, s in sorted(dataset['files'].items())]
+                    return self.reply(200, {'owner': m.group(1), 'id': m.group(2),
+                                            'title': dataset['title'], 'files': files})
+
+            if 'DELETE' == method:
+                m = DATASET_FILE.match(path)
+                if m:
+                    with state.lock:
+                        dataset = state.datasets.get((m.group(1), m.group(2)))
+                        if dataset is None or dataset['files'].pop(m.group(3), None) is None:
+                            return self.reply(404, {'message': 'file not found'})
+                    return self.reply(200, {'message': 'File deleted.'})
+                m = DATASET.match(path)
+                if m:
+                    with state.lock:
+                        if state.datasets.pop((m.group(1), m.group(2)), None) is None:
+                            return self.reply(404, {'message': 'dataset not found'})
+                    return self.reply(200, {'message': 'Dataset deleted.'})
+
+            return self.reply(404, {'message': 'no such endpoint'})
+
+        def do_POST(self):
+            self.handle_request('POST')
+
+        def do_PUT(self):
+            self.handle_request('PUT')
+
+        def do_GET(self):
+            self.handle_request('GET')
+
+        def do_DELETE(self):
+            self.handle_request('DELETE')
+
+    return Handler
+
+
+@contextlib.contextmanager
+def running_server(port=0, latency=0.0, bandwidth=0, error_rate=0.0, seed=None):
+    """Yield (base_url, state) for a server running on a background thread."""
+    settings = Settings(latency, bandwidth, error_rate, seed)
+    state = State()
+    server = ThreadingHTTPServer(('127.0.0.1', port), make_handler(settings, state))
+    server.daemon_threads = True
+    thread = threading.Thread(target=server.serve_forever)
+    thread.daemon = True
+    thread.start()
+    try:
+        yield 'http://127.0.0.1:{0}'.format(server.server_address[1]), state
+    finally:
+        server.shutdown()
+        server.server_close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Mock data.world API server')
+    parser.add_argument('--port', type=int, default=8080)
+    parser.add_argument('--latency', type=float, default=0.0, help='seconds added to each request')
+    parser.add_argument('--bandwidth', type=int, default=0, help='request body bytes per second, 0 is unlimited')
+    parser.add_argument('--error-rate', type=float, default=0.0, help='fraction of requests failed with a 500')
+    parser.add_argument('--seed', type=int, default=None)
+    args = parser.parse_args()
+
+    with running_server(args.port, args.latency, args.bandwidth, args.error_rate, args.seed) as (url, _):
+        print('listening on {0}'.format(url))
+        try:
+            while True:
+                time.sleep(3600)
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == '__main__':
+    main()
@@ -1,5 +1,5 @@
 import subprocess
 
 if __name__ == "__main__":
-    subprocess.call(['sudo', 'python', '-m', 'xmlrunner', 'irods.test.test_plugin_storage_tiering' ])
+    subprocess.call(['sudo', 'python', '-m', 'xmlrunner', 'irods.test.test_plugin_publishing' ])
 
@@ -1,11 +1,14 @@
 import os
 import sys
 import shutil
+import socket
 import contextlib
 import tempfile
+import glob
 import json
 import os.path
 
+import time
 from time import sleep
 
 if sys.version_info >= (2, 7):
@@ -21,6 +24,7 @@ from . import session
 from .. import test
 from .. import paths
 from .. import lib
+from . import mock_dataworld_server
 import ustrings
 
 @contextlib.contextmanager
@@ -1614,3 +1618,502 @@ class TestStorageTieringPluginMultiGroupRestage(ResourceBase, unittest.TestCase)
 
 
 
+
+
+@contextlib.contextmanager
+def publishing_configured(hosts, dataworld_settings=None, publishing_settings=None):
+    filename = paths.server_config_path()
+    with lib.file_backed_up(filename):
+        irods_config = IrodsConfig()
+        irods_config.server_config['advanced_settings']['rule_engine_server_sleep_time_in_seconds'] = 1
+
+        irods_config.server_config['plugin_configuration']['rule_engines'].insert(0,
+            {
+                "instance_name": "irods_rule_engine_plugin-dataworld-instance",
+                "plugin_name": "irods_rule_engine_plugin-dataworld",
+                "plugin_specific_configuration": dict({
+                    "hosts" : hosts if isinstance(hosts, list) else [hosts]
+                }, **(dataworld_settings or {}))
+            }
+        )
+
+        irods_config.server_config['plugin_configuration']['rule_engines'].insert(0,
+            {
+                "instance_name": "irods_rule_engine_plugin-publishing-instance",
+                "plugin_name": "irods_rule_engine_plugin-publishing",
+                "plugin_specific_configuration": dict({
+                    "minimum_delay_time" : "0",
+                    "maximum_delay_time" : "1",
+                    "log_level" : "LOG_NOTICE"
+                }, **(publishing_settings or {}))
+            }
+        )
+
+        irods_config.commit(irods_config.server_config, irods_config.server_config_path)
+        yield
+
+def wait_for(predicate, timeout=120, interval=0.25):
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        if predicate():
+            return True
+        sleep(interval)
+    return False
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    if not ordered:
+        return 0.0
+    index = min(len(ordered) - 1, int(round(fraction * (len(ordered) - 1))))
+    return ordered[index]
+
+class PublishingTestBase(ResourceBase):
+    api_token = 'mock_api_token'
+
+    def setUp(self):
+        super(PublishingTestBase, self).setUp()
+        with session.make_session_for_existing_admin() as admin_session:
+            admin_session.assert_icommand('iqdel -a')
+            admin_session.assert_icommand('imeta set -u ' + self.user0.username + ' irods::publishing::api_token ' + self.api_token)
+
+    def tearDown(self):
+        with session.make_session_for_existing_admin() as admin_session:
+            admin_session.assert_icommand('imeta rm -u ' + self.user0.username + ' irods::publishing::api_token ' + self.api_token)
+        super(PublishingTestBase, self).tearDown()
+
+    def make_collection(self, name, count, size):
+        local_dir = tempfile.mkdtemp()
+        try:
+            for i in range(count):
+                lib.make_file(os.path.join(local_dir, 'file_{0}'.format(i)), size, 'arbitrary')
+            self.user0.assert_icommand(['iput', '-r', local_dir, name])
+        finally:
+            shutil.rmtree(local_dir)
+        return self.user0.session_collection + '/' + name
+
+class TestPublishingPlugin(PublishingTestBase, unittest.TestCase):
+    def test_publish_and_purge_object(self):
+        with mock_dataworld_server.running_server() as (url, state):
+            with publishing_configured(url):
+                filename = 'test_publish_object'
+                lib.create_local_testfile(filename)
+                self.user0.assert_icommand('iput ' + filename)
+                self.user0.assert_icommand('imeta add -d ' + filename + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 1))
+
+                # a published object is immutable
+                self.user0.assert_icommand('iput -f ' + filename, 'STDERR_SINGLELINE', 'SYS_INVALID_OPR_TYPE')
+
+                self.admin.assert_icommand('imeta rm -d ' + self.user0.session_collection + '/' + filename + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+    def test_publish_and_purge_collection(self):
+        with mock_dataworld_server.running_server() as (url, state):
+            with publishing_configured(url):
+                collection = self.make_collection('test_publish_collection', 8, 1024)
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 8))
+
+                self.admin.assert_icommand('imeta rm -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+    def test_publish_collection_with_quote_in_path(self):
+        with mock_dataworld_server.running_server() as (url, state):
+            with publishing_configured(url):
+                collection = self.make_collection("test_publish_o'quote", 4, 1024)
+                self.user0.assert_icommand(['imeta', 'add', '-C', collection, 'irods::publishing::publish', 'dataworld'])
+                self.assertTrue(wait_for(lambda: state.file_count() == 4))
+
+                # the quoted path is found published
+                self.user0.assert_icommand(['irm', '-f', collection + '/file_0'], 'STDERR_SINGLELINE', 'SYS_INVALID_OPR_TYPE')
+
+                self.admin.assert_icommand(['imeta', 'rm', '-C', collection, 'irods::publishing::publish', 'dataworld'])
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+    def test_reconcile_collection_removes_deleted_object(self):
+        with mock_dataworld_server.running_server() as (url, state):
+            collection = self.make_collection('test_reconcile_removal', 4, 1024)
+            with publishing_configured(url):
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 4))
+
+                def fingerprinted():
+                    _, out, _ = self.user0.run_icommand(['imeta', 'ls', '-C', collection, 'irods::publishing::fingerprint'])
+                    return 'value' in out
+                self.assertTrue(wait_for(fingerprinted))
+
+            # the object is removed while the publishing plugin is not loaded,
+            # so its modify time tells the fingerprint nothing
+            self.user0.assert_icommand(['irm', '-f', collection + '/file_0'])
+
+            with publishing_configured(url):
+                self.user0.assert_icommand('imeta set -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 3))
+                names = set(n for d in state.datasets.values() for n in d['files'])
+                self.assertNotIn('file_0', names)
+
+                self.admin.assert_icommand('imeta rm -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+    def test_reconcile_collection_uploads_object_rewritten_with_same_size(self):
+        with mock_dataworld_server.running_server() as (url, state):
+            collection = self.make_collection('test_reconcile_rewrite', 4, 1024)
+            with publishing_configured(url):
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 4))
+
+                def fingerprinted():
+                    _, out, _ = self.user0.run_icommand(['imeta', 'ls', '-C', collection, 'irods::publishing::fingerprint'])
+                    return 'value' in out
+                self.assertTrue(wait_for(fingerprinted))
+
+            # the object is rewritten while the publishing plugin is not
+            # loaded, with other contents of the same size
+            local_file = os.path.join(tempfile.mkdtemp(), 'file_1')
+            try:
+                lib.make_file(local_file, 1024, 'random')
+                self.user0.assert_icommand(['iput', '-f', local_file, collection + '/file_1'])
+            finally:
+                shutil.rmtree(os.path.dirname(local_file))
+
+            with publishing_configured(url):
+                del state.uploaded_names[:]
+                self.user0.assert_icommand('imeta set -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: 'file_1' in state.uploaded_names))
+
+                self.admin.assert_icommand('imeta rm -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+    def test_full_reconcile_compares_checksums(self):
+        with mock_dataworld_server.running_server() as (url, state):
+            collection = self.make_collection('test_reconcile_checksums', 4, 1024)
+            self.user0.assert_icommand(['ichksum', '-r', collection], 'STDOUT_SINGLELINE', 'file_0')
+            settings = {'record_results': 'true'}
+            with publishing_configured(url, publishing_settings=settings):
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 4))
+
+                def recorded():
+                    _, out, _ = self.user0.run_icommand(['iquest', '%s',
+                        "SELECT count(DATA_ID) WHERE META_DATA_ATTR_NAME = 'irods::publishing::result::checksum' AND COLL_NAME = '" + collection + "'"])
+                    return out.strip()
+                self.assertTrue(wait_for(lambda: '4' == recorded()))
+
+            # a removal forces a full comparison, and the rewritten object
+            # keeps its size
+            self.user0.assert_icommand(['irm', '-f', collection + '/file_0'])
+            local_file = os.path.join(tempfile.mkdtemp(), 'file_1')
+            try:
+                lib.make_file(local_file, 1024, 'random')
+                self.user0.assert_icommand(['iput', '-fK', local_file, collection + '/file_1'])
+            finally:
+                shutil.rmtree(os.path.dirname(local_file))
+
+            with publishing_configured(url, publishing_settings=settings):
+                del state.uploaded_names[:]
+                self.user0.assert_icommand('imeta set -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 3 and 'file_1' in state.uploaded_names))
+                self.assertNotIn('file_2', state.uploaded_names)
+                self.assertNotIn('file_3', state.uploaded_names)
+
+                self.admin.assert_icommand('imeta rm -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+    def test_published_object_rejects_removal_and_new_neighbours_are_checked(self):
+        with mock_dataworld_server.running_server() as (url, state):
+            with publishing_configured(url):
+                collection = self.make_collection('test_immutable_classification', 2, 1024)
+                self.user0.assert_icommand('imeta add -d ' + collection + '/file_0 irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 1))
+
+                # removal is checked whatever the open flags of the request
+                self.user0.assert_icommand(['irm', '-f', collection + '/file_0'], 'STDERR_SINGLELINE', 'SYS_INVALID_OPR_TYPE')
+                self.user0.assert_icommand(['ils', collection + '/file_0'], 'STDOUT_SINGLELINE', 'file_0')
+
+                # a new object beside a published one is not itself published
+                filename = 'test_new_neighbour'
+                lib.create_local_testfile(filename)
+                self.user0.assert_icommand(['iput', filename, collection + '/' + filename])
+
+                self.admin.assert_icommand('imeta rm -d ' + collection + '/file_0 irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+    def test_published_path_filter_sees_new_publication(self):
+        with mock_dataworld_server.running_server() as (url, state):
+            with publishing_configured(url, publishing_settings={'published_filter_refresh_interval': '3600'}):
+                filename = 'test_published_filter'
+                lib.create_local_testfile(filename)
+                collection = self.make_collection('test_published_filter', 2, 1024)
+
+                # builds the filter before anything here is published
+                self.user0.assert_icommand(['iput', filename, collection + '/before'])
+
+                # the tag is added to the filter, no rebuild is needed to see it
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.user0.assert_icommand(['iput', filename, collection + '/after'], 'STDERR_SINGLELINE', 'SYS_INVALID_OPR_TYPE')
+                self.assertTrue(wait_for(lambda: state.file_count() == 3))
+
+                self.admin.assert_icommand('imeta rm -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+    def test_published_collection_rejects_bulk_put_and_rename(self):
+        with mock_dataworld_server.running_server() as (url, state):
+            with publishing_configured(url):
+                collection = self.make_collection('test_immutable_collection', 4, 1024)
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 4))
+
+                local_dir = tempfile.mkdtemp()
+                try:
+                    for i in range(4):
+                        lib.make_file(os.path.join(local_dir, 'bulk_{0}'.format(i)), 1024, 'arbitrary')
+                    self.user0.assert_icommand(['iput', '-b', '-r', local_dir, collection], 'STDERR_SINGLELINE', 'SYS_INVALID_OPR_TYPE')
+                finally:
+                    shutil.rmtree(local_dir)
+
+                self.user0.assert_icommand(['imv', collection + '/file_0', collection + '/renamed'], 'STDERR_SINGLELINE', 'SYS_INVALID_OPR_TYPE')
+
+                # renames outside the published collection are unaffected
+                unpublished = self.make_collection('test_mutable_collection', 4, 1024)
+                self.user0.assert_icommand(['imv', unpublished + '/file_0', unpublished + '/renamed'])
+
+                self.admin.assert_icommand('imeta rm -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+    def test_publish_collection_across_shards(self):
+        with mock_dataworld_server.running_server() as (url, state):
+            with publishing_configured(url, {'shard_maximum_objects': '3'}):
+                collection = self.make_collection('test_publish_shards', 8, 1024)
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 8))
+                self.assertEqual(3, len(state.datasets))
+                self.user0.assert_icommand('imeta ls -C ' + collection + ' irods::publishing::dataworld::dataset_id', 'STDOUT_SINGLELINE', 'value')
+
+                self.admin.assert_icommand('imeta rm -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+    def test_publish_collection_keeps_relative_paths(self):
+        with mock_dataworld_server.running_server() as (url, state):
+            with publishing_configured(url, {'file_names': 'relative_path'}):
+                local_dir = tempfile.mkdtemp()
+                try:
+                    for sub in ['a', 'b']:
+                        os.makedirs(os.path.join(local_dir, sub))
+                        lib.make_file(os.path.join(local_dir, sub, 'same_name'), 1024, 'arbitrary')
+                    self.user0.assert_icommand(['iput', '-r', local_dir, 'test_relative_paths'])
+                finally:
+                    shutil.rmtree(local_dir)
+
+                collection = self.user0.session_collection + '/test_relative_paths'
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 2))
+                names = set(n for d in state.datasets.values() for n in d['files'])
+                self.assertEqual(set(['a%2Fsame_name', 'b%2Fsame_name']), names)
+
+                self.admin.assert_icommand('imeta rm -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+    def test_publish_collection_assigns_persistent_identifiers(self):
+        # identifiers left in the pool by an earlier test would spare the request
+        for pool in glob.glob(os.path.join(tempfile.gettempdir(), 'irods_publishing_pids_*.pool')):
+            os.remove(pool)
+
+        with mock_dataworld_server.running_server() as (url, state):
+            with publishing_configured(url, {'pid_service': url, 'pid_batch_size': '16'}):
+                collection = self.make_collection('test_publish_pids', 8, 1024)
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 8))
+
+                def pid_count():
+                    _, out, _ = self.user0.run_icommand(['iquest', '%s',
+                        "SELECT count(DATA_ID) WHERE META_DATA_ATTR_NAME = 'irods::publishing::pid' AND COLL_NAME = '" + collection + "'"])
+                    return out.strip()
+                self.assertTrue(wait_for(lambda: '8' == pid_count()))
+                self.user0.assert_icommand('imeta ls -C ' + collection + ' irods::publishing::pid', 'STDOUT_SINGLELINE', 'value')
+
+                # the collection and its objects are minted for in a single request
+                self.assertEqual(1, len(state.pid_requests))
+
+                self.admin.assert_icommand('imeta rm -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+    def test_publish_collection_records_results(self):
+        with mock_dataworld_server.running_server() as (url, state):
+            with publishing_configured(url, publishing_settings={'record_results': 'true', 'result_batch_size': '3'}):
+                collection = self.make_collection('test_publish_results', 8, 1024)
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 8))
+
+                def recorded(attribute):
+                    _, out, _ = self.user0.run_icommand(['iquest', '%s',
+                        "SELECT count(DATA_ID) WHERE META_DATA_ATTR_NAME = '" + attribute + "' AND COLL_NAME = '" + collection + "'"])
+                    return out.strip()
+                self.assertTrue(wait_for(lambda: '8' == recorded('irods::publishing::result::published_at')))
+                self.assertEqual('8', recorded('irods::publishing::result::dataworld::dataset_id'))
+                self.user0.assert_icommand('imeta ls -C ' + collection + ' irods::publishing::result::published_at', 'STDOUT_SINGLELINE', 'value')
+
+                self.admin.assert_icommand('imeta rm -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+    def test_publish_collection_records_results_for_quoted_name(self):
+        with mock_dataworld_server.running_server() as (url, state):
+            with publishing_configured(url, publishing_settings={'record_results': 'true'}):
+                collection = self.make_collection('test_results_quoted_name', 2, 1024)
+                local_file = os.path.join(tempfile.mkdtemp(), "o'quote")
+                try:
+                    lib.make_file(local_file, 1024, 'arbitrary')
+                    self.user0.assert_icommand(['iput', local_file, collection + "/o'quote"])
+                finally:
+                    shutil.rmtree(os.path.dirname(local_file))
+
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 3))
+
+                def recorded():
+                    _, out, _ = self.user0.run_icommand(['iquest', '%s',
+                        "SELECT count(DATA_ID) WHERE META_DATA_ATTR_NAME = 'irods::publishing::result::published_at' AND COLL_NAME = '" + collection + "'"])
+                    return out.strip()
+                self.assertTrue(wait_for(lambda: '3' == recorded()))
+                self.user0.assert_icommand(['imeta', 'ls', '-d', collection + "/o'quote", 'irods::publishing::result::published_at'], 'STDOUT_SINGLELINE', 'value')
+
+                self.admin.assert_icommand('imeta rm -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+    def test_publish_collection_skips_unreachable_host(self):
+        unreachable = socket.socket()
+        unreachable.bind(('127.0.0.1', 0))
+        unreachable_url = 'http://127.0.0.1:{0}'.format(unreachable.getsockname()[1])
+        try:
+            with mock_dataworld_server.running_server() as (url, state):
+                with publishing_configured([unreachable_url, url]):
+                    collection = self.make_collection('test_unreachable_host', 8, 1024)
+                    self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                    self.assertTrue(wait_for(lambda: state.file_count() == 8))
+        finally:
+            unreachable.close()
+
+    def publishing_status(self, session):
+        rule = json.dumps({
+            'rule-engine-instance-name': 'irods_rule_engine_plugin-publishing-instance',
+            'rule-engine-operation': 'irods_policy_publishing_status'})
+        return session.run_icommand(['irule', '-r', 'irods_rule_engine_plugin-publishing-instance', rule, 'null', 'ruleExecOut'])
+
+    def test_status_reports_completed_collection(self):
+        with mock_dataworld_server.running_server() as (url, state):
+            with publishing_configured(url):
+                collection = self.make_collection('test_status_collection', 4, 1024)
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == 4))
+
+                def completed():
+                    out, _, _ = self.publishing_status(self.admin)
+                    status = json.loads(out)
+                    return any(j['path'] == collection and j['objects-done'] == 4 and j['bytes-done'] == 4096
+                               for j in status['completed'])
+                self.assertTrue(wait_for(completed))
+
+                # the status is only available to administrators
+                _, err, _ = self.publishing_status(self.user0)
+                self.assertIn('SYS_NO_API_PRIV', err)
+
+    def test_removing_tag_cancels_running_publication(self):
+        with mock_dataworld_server.running_server(latency=0.25) as (url, state):
+            with publishing_configured(url):
+                collection = self.make_collection('test_cancel_collection', 64, 1024)
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() > 0))
+
+                self.admin.assert_icommand('imeta rm -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+
+                def cancelled():
+                    out, _, _ = self.publishing_status(self.admin)
+                    return any(j['path'] == collection for j in json.loads(out)['cancelled'])
+                self.assertTrue(wait_for(cancelled))
+
+                # nothing is uploaded once the job has stopped
+                uploads = len(state.uploads)
+                sleep(2)
+                self.assertEqual(uploads, len(state.uploads))
+
+    def test_cancelling_publication_removes_tag(self):
+        with mock_dataworld_server.running_server(latency=0.25) as (url, state):
+            with publishing_configured(url):
+                collection = self.make_collection('test_cancel_removes_tag', 128, 1024)
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() > 0))
+
+                rule = json.dumps({
+                    'rule-engine-instance-name': 'irods_rule_engine_plugin-publishing-instance',
+                    'rule-engine-operation': 'irods_policy_publishing_cancel',
+                    'path': collection})
+                self.admin.assert_icommand(['irule', '-r', 'irods_rule_engine_plugin-publishing-instance', rule, 'null', 'ruleExecOut'], 'STDOUT_SINGLELINE', 'cancelled')
+
+                # the partial dataset is purged and the collection no longer reads as published
+                self.assertTrue(wait_for(lambda: len(state.datasets) == 0))
+                def untagged():
+                    _, out, _ = self.user0.run_icommand(['imeta', 'ls', '-C', collection, 'irods::publishing::publish'])
+                    return 'dataworld' not in out
+                self.assertTrue(wait_for(untagged))
+
+class TestPublishingBenchmark(PublishingTestBase, unittest.TestCase):
+    """Reports publish throughput and latency against the mock data.world server.
+
+    Counts and sizes may be scaled with PUBLISHING_BENCHMARK_SCALE, the report is
+    written to stdout and appended to PUBLISHING_BENCHMARK_OUTPUT when it is set."""
+
+    scale = int(os.environ.get('PUBLISHING_BENCHMARK_SCALE', '1'))
+
+    def report(self, label, started, state, object_count, total_bytes):
+        finished = max(end for _, end, _ in state.uploads)
+        elapsed = max(finished - started, 1e-6)
+        upload_latencies = [end - begin for begin, end, _ in state.uploads]
+        completion_latencies = [end - started for _, end, _ in state.uploads]
+        line = ('{0:<40} objects/s {1:10.2f}  MB/s {2:8.2f}  '
+                'upload p50 {3:7.3f}s p99 {4:7.3f}s  completion p50 {5:7.3f}s p99 {6:7.3f}s').format(
+                    label,
+                    object_count / elapsed,
+                    total_bytes / elapsed / (1024 * 1024),
+                    percentile(upload_latencies, 0.50),
+                    percentile(upload_latencies, 0.99),
+                    percentile(completion_latencies, 0.50),
+                    percentile(completion_latencies, 0.99))
+        print(line)
+        output = os.environ.get('PUBLISHING_BENCHMARK_OUTPUT')
+        if output:
+            with open(output, 'a') as f:
+                f.write(line + '\n')
+
+    def benchmark_objects(self, count, size, **server_settings):
+        with mock_dataworld_server.running_server(**server_settings) as (url, state):
+            with publishing_configured(url):
+                collection = self.make_collection('bench_objects_{0}_{1}'.format(count, size), count, size)
+                started = time.time()
+                for i in range(count):
+                    self.user0.assert_icommand('imeta add -d {0}/file_{1} irods::publishing::publish dataworld'.format(collection, i))
+                self.assertTrue(wait_for(lambda: state.file_count() == count, timeout=600))
+                self.report('objects count={0} size={1}'.format(count, size), started, state, count, count * size)
+
+    def benchmark_collection(self, count, size, **server_settings):
+        with mock_dataworld_server.running_server(**server_settings) as (url, state):
+            with publishing_configured(url):
+                collection = self.make_collection('bench_collection_{0}_{1}'.format(count, size), count, size)
+                started = time.time()
+                self.user0.assert_icommand('imeta add -C ' + collection + ' irods::publishing::publish dataworld')
+                self.assertTrue(wait_for(lambda: state.file_count() == count, timeout=600))
+                self.report('collection count={0} size={1}'.format(count, size), started, state, count, count * size)
+
+    def test_object_publish_small(self):
+        self.benchmark_objects(16 * self.scale, 4 * 1024)
+
+    def test_collection_publish_many_small(self):
+        self.benchmark_collection(256 * self.scale, 4 * 1024)
+
+    def test_collection_publish_large(self):
+        self.benchmark_collection(8 * self.scale, 16 * 1024 * 1024)
+
+    def test_collection_publish_with_latency(self):
+        self.benchmark_collection(64 * self.scale, 64 * 1024, latency=0.05)
+
+    def test_collection_publish_with_bandwidth_limit(self):
+        self.benchmark_collection(8 * self.scale, 4 * 1024 * 1024, bandwidth=64 * 1024 * 1024)
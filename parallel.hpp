@@ -0,0 +1,175 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace irods {
+    namespace publishing {
+        // apply _fn to every item using at most _concurrency threads, the first
+        // exception thrown by _fn is rethrown once all workers have finished.
+        // _fn must not touch the rsComm, which is not thread safe
+        template<typename Container, typename Function>
+        void parallel_for_each(
+            const Container&  _items,
+            const std::size_t _concurrency,
+            Function          _fn) {
+            const std::size_t count = _items.size();
+            if(0 == count) {
+                return;
+            }
+
+            const std::size_t workers = std::max<std::size_t>(1, std::min(_concurrency, count));
+            if(1 == workers) {
+                for(const auto& i : _items) {
+                    _fn(i);
+                }
+                return;
+            }
+
+            std::atomic<std::size_t> next{0};
+            std::exception_ptr       error;
+            std::mutex               error_mutex;
+
+            auto work = [&] {
+                for(std::size_t i = next++; i < count; i = next++) {
+                    try {
+                        _fn(*std::next(std::begin(_items), i));
+                    }
+                    catch(...) {
+                        std::lock_guard<std::mutex> lock{error_mutex};
+                        if(!error) {
+                            error = std::current_exception();
+                        }
+                    }
+                }
+            };
+
+            std::vector<std::thread> threads;
+            threads.reserve(workers);
+            for(std::size_t t = 0; t < workers; ++t) {
+                threads.emplace_back(work);
+            }
+
+            for(auto& t : threads) {
+                t.join();
+            }
+
+            if(error) {
+                std::rethrow_exception(error);
+            }
+        } // parallel_for_each
+
+        // runs tasks submitted by a single producer on _concurrency threads.
+        // submit blocks while _capacity tasks are waiting, bounding the work
+        // the producer may buffer ahead of the workers.  the first exception
+        // thrown by a task is rethrown by wait, tasks still queued are dropped.
+        // like parallel_for_each, tasks must not touch the rsComm
+        class worker_pool {
+            public:
+            worker_pool(
+                const std::size_t _concurrency,
+                const std::size_t _capacity) :
+                  capacity_{std::max<std::size_t>(1, _capacity)} {
+                const auto workers = std::max<std::size_t>(1, _concurrency);
+                threads_.reserve(workers);
+                for(std::size_t t = 0; t < workers; ++t) {
+                    threads_.emplace_back([this] { work(); });
+                }
+            } // ctor
+
+            ~worker_pool() {
+                try {
+                    wait();
+                }
+                catch(...) {
+                }
+            } // dtor
+
+            worker_pool(const worker_pool&) = delete;
+            worker_pool& operator=(const worker_pool&) = delete;
+
+            // false once a task has failed, the task is then discarded
+            bool submit(std::function<void()> _task) {
+                std::unique_lock<std::mutex> lock{mutex_};
+                not_full_.wait(lock, [this] { return tasks_.size() < capacity_ || error_; });
+                if(error_) {
+                    return false;
+                }
+
+                tasks_.push_back(std::move(_task));
+                not_empty_.notify_one();
+                return true;
+            } // submit
+
+            void wait() {
+                {
+                    std::lock_guard<std::mutex> lock{mutex_};
+                    done_ = true;
+                }
+                not_empty_.notify_all();
+
+                for(auto& t : threads_) {
+                    if(t.joinable()) {
+                        t.join();
+                    }
+                }
+
+                if(error_) {
+                    std::rethrow_exception(std::exchange(error_, nullptr));
+                }
+            } // wait
+
+            private:
+            void work() {
+                while(true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock{mutex_};
+                        not_empty_.wait(lock, [this] { return !tasks_.empty() || done_ || error_; });
+                        if(error_ || tasks_.empty()) {
+                            return;
+                        }
+
+                        task = std::move(tasks_.front());
+                        tasks_.pop_front();
+                    }
+                    not_full_.notify_one();
+
+                    try {
+                        task();
+                    }
+                    catch(...) {
+                        std::lock_guard<std::mutex> lock{mutex_};
+                        if(!error_) {
+                            error_ = std::current_exception();
+                        }
+                        tasks_.clear();
+                        not_full_.notify_all();
+                        not_empty_.notify_all();
+                    }
+                }
+            } // work
+
+            const std::size_t                  capacity_;
+            std::mutex                         mutex_;
+            std::condition_variable            not_empty_;
+            std::condition_variable            not_full_;
+            std::deque<std::function<void()>>  tasks_;
+            std::vector<std::thread>           threads_;
+            std::exception_ptr                 error_;
+            bool                               done_{};
+        }; // class worker_pool
+    } // namespace publishing
+} // namespace irods
+
+#endif // PARALLEL_HPP
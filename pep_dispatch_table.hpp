@@ -0,0 +1,97 @@
+#ifndef PEP_DISPATCH_TABLE_HPP
+#define PEP_DISPATCH_TABLE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace irods {
+    namespace publishing {
+        constexpr std::uint32_t fnv1a(
+            std::string_view _str,
+            std::uint32_t    _seed) noexcept {
+            std::uint32_t hash = 2166136261u ^ _seed;
+            for(const char c : _str) {
+                hash ^= static_cast<std::uint8_t>(c);
+                hash *= 16777619u;
+            }
+            return hash;
+        } // fnv1a
+
+        // a perfect hash table of string keys built at compile time, a seed is
+        // searched for which places every key in its own slot so a lookup is
+        // a single hash, a single slot and a single string compare
+        template<typename Value, std::size_t N>
+        class static_dispatch_table {
+            public:
+            struct entry {
+                std::string_view key;
+                Value            value;
+            };
+
+            static constexpr std::size_t slot_count = [] {
+                std::size_t s = 1;
+                while(s < 2 * N) { s <<= 1; }
+                return s;
+            }();
+
+            constexpr explicit static_dispatch_table(const std::array<entry, N>& _entries)
+                : entries_{_entries} {
+                for(std::uint32_t seed = 0; seed < max_seed; ++seed) {
+                    if(place(seed)) {
+                        seed_ = seed;
+                        return;
+                    }
+                }
+
+                // only reachable during constant evaluation with an unlucky key set
+                throw std::logic_error("no perfect hash seed found");
+            }
+
+            constexpr const Value* find(std::string_view _key) const noexcept {
+                const auto i = index_of(_key);
+                return N == i ? nullptr : &entries_[i].value;
+            }
+
+            // position of _key in entries(), N when it is not present
+            constexpr std::size_t index_of(std::string_view _key) const noexcept {
+                const auto& s = slots_[fnv1a(_key, seed_) & (slot_count - 1)];
+                if(s.used && entries_[s.index].key == _key) {
+                    return s.index;
+                }
+                return N;
+            }
+
+            constexpr const std::array<entry, N>& entries() const noexcept { return entries_; }
+
+            private:
+            static constexpr std::uint32_t max_seed = 1u << 16;
+
+            struct slot {
+                bool        used{};
+                std::size_t index{};
+            };
+
+            constexpr bool place(const std::uint32_t _seed) {
+                slots_ = {};
+                for(std::size_t i = 0; i < N; ++i) {
+                    auto& s = slots_[fnv1a(entries_[i].key, _seed) & (slot_count - 1)];
+                    if(s.used) {
+                        return false;
+                    }
+                    s.used  = true;
+                    s.index = i;
+                }
+                return true;
+            }
+
+            std::array<entry, N>           entries_;
+            std::array<slot, slot_count>   slots_{};
+            std::uint32_t                  seed_{};
+        }; // class static_dispatch_table
+    } // namespace publishing
+} // namespace irods
+
+#endif // PEP_DISPATCH_TABLE_HPP
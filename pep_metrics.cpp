@@ -0,0 +1,222 @@
+#include "pep_metrics.hpp"
+#include "catalog.hpp"
+#include "pep_dispatch_table.hpp"
+#include "shared_segment.hpp"
+
+#include <irods/rodsLog.h>
+
+#include <boost/format.hpp>
+
+#include <cstdio>
+#include <sstream>
+
+#include <unistd.h>
+
+namespace {
+    uint64_t now_in_microseconds() {
+        using namespace std::chrono;
+        return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+    } // now_in_microseconds
+
+    std::string seconds(const uint64_t _micros) {
+        return boost::str(boost::format("%.6f") % (static_cast<double>(_micros) / 1e6));
+    } // seconds
+
+    void write_histogram(
+        std::ostream&                                _out,
+        const std::string&                           _name,
+        const std::string&                           _labels,
+        const irods::publishing::latency_histogram& _histogram) {
+        using irods::publishing::latency_histogram;
+
+        // cumulative counts at each occupied bucket boundary
+        uint64_t cumulative{};
+        for(std::size_t b = 0; b < latency_histogram::bucket_count; ++b) {
+            const auto n = _histogram.bucket(b);
+            if(0 == n) {
+                continue;
+            }
+            cumulative += n;
+            _out << _name << "_bucket{" << _labels << ",le=\""
+                 << seconds(latency_histogram::bucket_upper_bound(b)) << "\"} "
+                 << cumulative << "\n";
+        }
+
+        _out << _name << "_bucket{" << _labels << ",le=\"+Inf\"} " << _histogram.count() << "\n"
+             << _name << "_sum{" << _labels << "} " << seconds(_histogram.sum()) << "\n"
+             << _name << "_count{" << _labels << "} " << _histogram.count() << "\n";
+    } // write_histogram
+} // namespace
+
+namespace irods {
+    namespace publishing {
+        pep_metrics::pep_metrics(
+            const std::vector<std::string>& _pep_names,
+            const std::string&              _export_path,
+            const int                       _export_interval) :
+              pep_names_{_pep_names}
+            , export_path_{_export_path}
+            , export_interval_{static_cast<uint64_t>(std::max(1, _export_interval)) * 1000000} {
+            if(pep_names_.size() > maximum_peps) {
+                pep_names_.resize(maximum_peps);
+            }
+
+            // the segment is named for the pep set and layout so agents built
+            // from another version never interpret each other's counters
+            std::string layout{std::to_string(sizeof(segment))};
+            for(const auto& n : pep_names_) {
+                layout += ":" + n;
+            }
+
+            segment_ = static_cast<segment*>(map_shared_segment(
+                           boost::str(boost::format("irods_publishing_pep_metrics_%08x.shm")
+                           % fnv1a(layout, 0)),
+                           sizeof(segment)));
+        } // ctor
+
+        pep_metrics::~pep_metrics() {
+            unmap_shared_segment(segment_, sizeof(segment));
+        } // dtor
+
+        void pep_metrics::record(
+            const std::size_t _pep,
+            const std::size_t _queries,
+            const uint64_t    _micros) noexcept {
+            if(!segment_ || _pep >= pep_names_.size()) {
+                return;
+            }
+
+            segment_->histograms[_pep][query_bucket(_queries)].record(_micros);
+        } // record
+
+        void pep_metrics::record_job(const pipeline_metrics& _job) noexcept {
+            if(!segment_) {
+                return;
+            }
+
+            segment_->job_stages[0].record(_job.queue_wait());
+            if(_job.dataset_creation() > 0) {
+                segment_->job_stages[1].record(_job.dataset_creation());
+            }
+            segment_->job_stages[2].merge(_job.reads());
+            segment_->job_stages[3].merge(_job.uploads());
+            segment_->job_stages[4].record(_job.total());
+
+            segment_->jobs.fetch_add(1, std::memory_order_relaxed);
+            segment_->published_objects.fetch_add(_job.objects(), std::memory_order_relaxed);
+            segment_->published_bytes.fetch_add(_job.bytes(), std::memory_order_relaxed);
+        } // record_job
+
+        void pep_metrics::export_if_due() {
+            if(!segment_ || export_path_.empty()) {
+                return;
+            }
+
+            const auto now = now_in_microseconds();
+            auto last = segment_->last_export.load(std::memory_order_relaxed);
+            if(now - last < export_interval_ ||
+               !segment_->last_export.compare_exchange_strong(last, now)) {
+                return;
+            }
+
+            const std::string tmp_path{export_path_ + ".tmp." + std::to_string(::getpid())};
+            std::FILE* f = std::fopen(tmp_path.c_str(), "w");
+            if(!f) {
+                rodsLog(
+                    LOG_ERROR,
+                    "pep_metrics failed to write [%s]",
+                    tmp_path.c_str());
+                return;
+            }
+
+            const auto text = to_prometheus();
+            const bool written = text.size() == std::fwrite(text.data(), 1, text.size(), f);
+            if(0 != std::fclose(f) || !written ||
+               0 != std::rename(tmp_path.c_str(), export_path_.c_str())) {
+                rodsLog(
+                    LOG_ERROR,
+                    "pep_metrics failed to export [%s]",
+                    export_path_.c_str());
+                std::remove(tmp_path.c_str());
+            }
+        } // export_if_due
+
+        std::string pep_metrics::to_prometheus() const {
+            const std::string pep_name{"irods_publishing_pep_duration_seconds"};
+            const std::string stage_name{"irods_publishing_job_stage_seconds"};
+            std::ostringstream out;
+            out << "# HELP " << pep_name << " Time the publishing plugin adds to each policy enforcement point, by catalog queries issued.\n"
+                << "# TYPE " << pep_name << " histogram\n";
+            if(!segment_) {
+                return out.str();
+            }
+
+            for(std::size_t p = 0; p < pep_names_.size(); ++p) {
+                for(std::size_t q = 0; q < query_buckets.size(); ++q) {
+                    const auto& h = segment_->histograms[p][q];
+                    if(0 == h.count()) {
+                        continue;
+                    }
+
+                    write_histogram(
+                        out,
+                        pep_name,
+                        "pep=\"" + pep_names_[p] + "\",queries=\"" + query_buckets[q] + "\"",
+                        h);
+                }
+            }
+
+            out << "# HELP " << stage_name << " Duration of each stage of publication jobs, object stages are per object.\n"
+                << "# TYPE " << stage_name << " histogram\n";
+            for(std::size_t s = 0; s < stages.size(); ++s) {
+                if(0 == segment_->job_stages[s].count()) {
+                    continue;
+                }
+
+                write_histogram(out, stage_name, std::string{"stage=\""} + stages[s] + "\"", segment_->job_stages[s]);
+            }
+
+            const auto counter = [&](const char* _name, const char* _help, const std::atomic<uint64_t>& _value) {
+                out << "# HELP " << _name << " " << _help << "\n"
+                    << "# TYPE " << _name << " counter\n"
+                    << _name << " " << _value.load(std::memory_order_relaxed) << "\n";
+            };
+            counter("irods_publishing_jobs_total", "Completed publication jobs.", segment_->jobs);
+            counter("irods_publishing_published_objects_total", "Objects uploaded by publication jobs.", segment_->published_objects);
+            counter("irods_publishing_published_bytes_total", "Bytes uploaded by publication jobs.", segment_->published_bytes);
+
+            return out.str();
+        } // to_prometheus
+
+        pep_timer::pep_timer(
+            pep_metrics*      _metrics,
+            const std::size_t _pep) :
+              metrics_{_metrics}
+            , pep_{_pep}
+            , queries_before_{catalog::thread_query_count()}
+            , started_{std::chrono::steady_clock::now()} {
+        } // ctor
+
+        pep_timer::~pep_timer() {
+            if(!metrics_) {
+                return;
+            }
+
+            const auto elapsed = std::chrono::steady_clock::now() - started_;
+            metrics_->record(
+                pep_,
+                catalog::thread_query_count() - queries_before_,
+                std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+
+            try {
+                metrics_->export_if_due();
+            }
+            catch(const std::exception& _e) {
+                rodsLog(
+                    LOG_ERROR,
+                    "pep_metrics export failed [%s]",
+                    _e.what());
+            }
+        } // dtor
+    } // namespace publishing
+} // namespace irods
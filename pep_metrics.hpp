@@ -0,0 +1,98 @@
+#ifndef PEP_METRICS_HPP
+#define PEP_METRICS_HPP
+
+#include "latency_histogram.hpp"
+#include "pipeline_metrics.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace irods {
+    namespace publishing {
+        // latency of each policy enforcement point handled by the plugin, by
+        // the number of catalog queries the call issued, and of each stage of
+        // the publication jobs.  the histograms live in a file mapped by every
+        // agent so they aggregate across processes, and whichever agent first
+        // notices the export interval has passed writes them to the export
+        // file in the prometheus text format
+        class pep_metrics {
+            public:
+            static constexpr std::size_t maximum_peps = 32;
+
+            static constexpr std::array<const char*, 7> query_buckets{
+                "0", "1", "2", "3-4", "5-8", "9-16", "17+"};
+
+            static constexpr std::array<const char*, 5> stages{
+                "queue_wait", "dataset_creation", "object_read", "object_upload", "total"};
+
+            static constexpr std::size_t query_bucket(const std::size_t _queries) noexcept {
+                return _queries <= 2  ? _queries :
+                       _queries <= 4  ? 3 :
+                       _queries <= 8  ? 4 :
+                       _queries <= 16 ? 5 : 6;
+            } // query_bucket
+
+            pep_metrics(
+                const std::vector<std::string>& _pep_names,
+                const std::string&              _export_path,
+                const int                       _export_interval);
+            ~pep_metrics();
+
+            pep_metrics(const pep_metrics&) = delete;
+            pep_metrics& operator=(const pep_metrics&) = delete;
+
+            void record(
+                const std::size_t _pep,
+                const std::size_t _queries,
+                const uint64_t    _micros) noexcept;
+
+            // fold a completed publication job into the stage histograms
+            void record_job(const pipeline_metrics& _job) noexcept;
+
+            // write the export file if no agent has within the interval
+            void export_if_due();
+
+            std::string to_prometheus() const;
+
+            private:
+            struct segment {
+                std::atomic<uint64_t> last_export; // microseconds since the epoch
+                latency_histogram     histograms[maximum_peps][query_buckets.size()];
+                latency_histogram     job_stages[stages.size()];
+                std::atomic<uint64_t> jobs;
+                std::atomic<uint64_t> published_objects;
+                std::atomic<uint64_t> published_bytes;
+            }; // struct segment
+
+            std::vector<std::string> pep_names_;
+            std::string              export_path_;
+            uint64_t                 export_interval_;
+            segment*                 segment_{};
+        }; // class pep_metrics
+
+        // times a single pep invocation, recording it on scope exit
+        class pep_timer {
+            public:
+            pep_timer(
+                pep_metrics*      _metrics,
+                const std::size_t _pep);
+            ~pep_timer();
+
+            pep_timer(const pep_timer&) = delete;
+            pep_timer& operator=(const pep_timer&) = delete;
+
+            private:
+            pep_metrics*                          metrics_;
+            std::size_t                           pep_;
+            std::size_t                           queries_before_;
+            std::chrono::steady_clock::time_point started_;
+        }; // class pep_timer
+    } // namespace publishing
+} // namespace irods
+
+#endif // PEP_METRICS_HPP
@@ -0,0 +1,127 @@
+#include "pid_pool.hpp"
+
+#include <irods/irods_exception.hpp>
+#include <irods/rodsErrorTable.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+
+#include <cerrno>
+#include <sstream>
+
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    // closing the descriptor releases the lock
+    class locked_file {
+        public:
+        explicit locked_file(const std::string& _path) {
+            fd_ = ::open(_path.c_str(), O_CREAT | O_RDWR, 0600);
+            if(fd_ < 0) {
+                THROW(
+                    UNIX_FILE_OPEN_ERR - errno,
+                    boost::format("failed to open pid pool [%s]")
+                    % _path);
+            }
+
+            if(0 != ::flock(fd_, LOCK_EX)) {
+                const int error = errno;
+                ::close(fd_);
+                THROW(
+                    UNIX_FILE_OPEN_ERR - error,
+                    boost::format("failed to lock pid pool [%s]")
+                    % _path);
+            }
+        } // ctor
+
+        ~locked_file() {
+            ::close(fd_);
+        } // dtor
+
+        locked_file(const locked_file&) = delete;
+        locked_file& operator=(const locked_file&) = delete;
+
+        int fd() const { return fd_; }
+
+        private:
+        int fd_{-1};
+    }; // class locked_file
+} // namespace
+
+namespace irods {
+    namespace publishing {
+        pid_pool::pid_pool(
+            const std::string& _name,
+            minter             _mint,
+            const std::size_t  _batch_size) :
+              path_{(boost::filesystem::temp_directory_path() /
+                     boost::str(boost::format("irods_publishing_pids_%s.pool") % _name)).string()}
+            , mint_{std::move(_mint)}
+            , batch_size_{_batch_size} {
+        } // ctor
+
+        std::vector<std::string> pid_pool::take(const std::size_t _count) {
+            if(0 == _count) {
+                return {};
+            }
+
+            locked_file file{path_};
+
+            std::string contents;
+            char buffer[8192];
+            for(ssize_t n; (n = ::read(file.fd(), buffer, sizeof(buffer))) != 0;) {
+                if(n < 0) {
+                    THROW(
+                        UNIX_FILE_READ_ERR - errno,
+                        boost::format("failed to read pid pool [%s]")
+                        % path_);
+                }
+                contents.append(buffer, n);
+            }
+
+            std::vector<std::string> pids;
+            std::istringstream lines{contents};
+            for(std::string line; std::getline(lines, line);) {
+                if(!line.empty()) {
+                    pids.push_back(std::move(line));
+                }
+            }
+
+            if(pids.size() < _count) {
+                const auto wanted = _count - pids.size() + batch_size_;
+                auto minted = mint_(wanted);
+                if(minted.size() + pids.size() < _count) {
+                    THROW(
+                        SYS_INTERNAL_ERR,
+                        boost::format("pid service minted [%zu] of the [%zu] identifiers requested")
+                        % minted.size()
+                        % wanted);
+                }
+                pids.insert(pids.end(), minted.begin(), minted.end());
+            }
+
+            std::vector<std::string> taken(pids.begin(), pids.begin() + _count);
+
+            std::string remaining;
+            for(auto i = pids.begin() + _count; i != pids.end(); ++i) {
+                remaining += *i;
+                remaining += '\n';
+            }
+
+            if(0 != ::ftruncate(file.fd(), 0) ||
+               static_cast<ssize_t>(remaining.size()) != ::pwrite(file.fd(), remaining.data(), remaining.size(), 0)) {
+                // a partial line would later be issued as an identifier
+                const int error = errno;
+                (void) ::ftruncate(file.fd(), 0);
+                THROW(
+                    UNIX_FILE_WRITE_ERR - error,
+                    boost::format("failed to write pid pool [%s]")
+                    % path_);
+            }
+
+            return taken;
+        } // take
+    } // namespace publishing
+} // namespace irods
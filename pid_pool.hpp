@@ -0,0 +1,39 @@
+#ifndef PID_POOL_HPP
+#define PID_POOL_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace irods {
+    namespace publishing {
+        // persistent identifiers minted ahead of need, shared by every agent on
+        // the host through a file beneath the temporary directory holding one
+        // identifier per line and guarded by an advisory lock.  an agent which
+        // finds too few for its request mints what it lacks plus a batch, so
+        // the minting service sees a request per batch rather than per object.
+        // identifiers lost to a crash between minting and writing are unused,
+        // never issued twice
+        class pid_pool {
+            public:
+            // mint _count identifiers, throwing when the service fails
+            using minter = std::function<std::vector<std::string>(std::size_t)>;
+
+            pid_pool(
+                const std::string& _name,
+                minter             _mint,
+                const std::size_t  _batch_size);
+
+            // take _count identifiers out of the pool, minting any missing
+            std::vector<std::string> take(const std::size_t _count);
+
+            private:
+            std::string path_;
+            minter      mint_;
+            std::size_t batch_size_;
+        }; // class pid_pool
+    } // namespace publishing
+} // namespace irods
+
+#endif // PID_POOL_HPP
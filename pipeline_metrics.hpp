@@ -0,0 +1,121 @@
+#ifndef PIPELINE_METRICS_HPP
+#define PIPELINE_METRICS_HPP
+
+#include "latency_histogram.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace irods {
+    namespace publishing {
+        // timing of a single publication job from the moment it was tagged to
+        // its completion.  backends report dataset creation and each object
+        // read and upload, which may happen on several threads at once
+        class pipeline_metrics {
+            public:
+            // microseconds since the epoch
+            static uint64_t now() noexcept {
+                using namespace std::chrono;
+                return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+            } // now
+
+            // a job tagged before this instrumentation existed has no tag time,
+            // its queue wait is then reported as zero
+            explicit pipeline_metrics(const uint64_t _tagged_at) :
+                  picked_up_at_{now()}
+                , tagged_at_{_tagged_at > 0 ? _tagged_at : picked_up_at_} {
+            } // ctor
+
+            void dataset_created() noexcept {
+                uint64_t expected{};
+                dataset_created_at_.compare_exchange_strong(expected, now());
+            } // dataset_created
+
+            void object_read(const uintmax_t _bytes, const uint64_t _micros) noexcept {
+                read_bytes_.fetch_add(_bytes, std::memory_order_relaxed);
+                reads_.record(_micros);
+            } // object_read
+
+            void object_uploaded(const uintmax_t _bytes, const uint64_t _micros) noexcept {
+                upload_bytes_.fetch_add(_bytes, std::memory_order_relaxed);
+                uploads_.record(_micros);
+                if(on_upload_) {
+                    on_upload_(_bytes);
+                }
+            } // object_uploaded
+
+            // an object the backend skipped after failing to publish it
+            void object_failed() noexcept {
+                failures_.fetch_add(1, std::memory_order_relaxed);
+            } // object_failed
+
+            // invoked with the size of each object as it is uploaded, which
+            // may be on several threads at once
+            void on_upload(std::function<void(uintmax_t)> _callback) {
+                on_upload_ = std::move(_callback);
+            } // on_upload
+
+            void complete() noexcept {
+                completed_at_ = now();
+            } // complete
+
+            uint64_t queue_wait() const noexcept { return picked_up_at_ - tagged_at_; }
+            uint64_t total() const noexcept { return completed_at_ > 0 ? completed_at_ - tagged_at_ : 0; }
+            uint64_t dataset_creation() const noexcept {
+                const auto created = dataset_created_at_.load();
+                return created > 0 ? created - picked_up_at_ : 0;
+            }
+            uintmax_t bytes() const noexcept { return upload_bytes_.load(); }
+            uint64_t objects() const noexcept { return uploads_.count(); }
+            uint64_t failures() const noexcept { return failures_.load(); }
+
+            const latency_histogram& reads() const noexcept { return reads_; }
+            const latency_histogram& uploads() const noexcept { return uploads_; }
+
+            nlohmann::json to_json() const {
+                const auto seconds = [](const uint64_t _micros) {
+                    return static_cast<double>(_micros) / 1e6;
+                };
+                const auto rate = [&](const uintmax_t _bytes, const uint64_t _micros) {
+                    return _micros > 0 ? static_cast<double>(_bytes) / seconds(_micros) : 0.0;
+                };
+                const auto processing = completed_at_ > 0 ? completed_at_ - picked_up_at_ : 0;
+
+                return nlohmann::json{
+                    {"tagged-at",                 tagged_at_},
+                    {"picked-up-at",              picked_up_at_},
+                    {"dataset-created-at",        dataset_created_at_.load()},
+                    {"completed-at",              completed_at_},
+                    {"queue-wait-seconds",        seconds(queue_wait())},
+                    {"dataset-creation-seconds",  seconds(dataset_creation())},
+                    {"read-seconds",              seconds(reads_.sum())},
+                    {"upload-seconds",            seconds(uploads_.sum())},
+                    {"total-seconds",             seconds(total())},
+                    {"objects",                   objects()},
+                    {"failed-objects",            failures()},
+                    {"bytes",                     bytes()},
+                    {"read-bytes-per-second",     rate(read_bytes_.load(), reads_.sum())},
+                    {"upload-bytes-per-second",   rate(upload_bytes_.load(), uploads_.sum())},
+                    {"job-bytes-per-second",      rate(upload_bytes_.load(), processing)}};
+            } // to_json
+
+            private:
+            const uint64_t        picked_up_at_;
+            const uint64_t        tagged_at_;
+            std::atomic<uint64_t> dataset_created_at_{};
+            uint64_t              completed_at_{};
+            std::atomic<uintmax_t> read_bytes_{};
+            std::atomic<uintmax_t> upload_bytes_{};
+            std::atomic<uint64_t> failures_{};
+            latency_histogram     reads_{};
+            latency_histogram     uploads_{};
+            std::function<void(uintmax_t)> on_upload_;
+        }; // class pipeline_metrics
+    } // namespace publishing
+} // namespace irods
+
+#endif // PIPELINE_METRICS_HPP
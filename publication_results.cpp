@@ -0,0 +1,183 @@
+#include "publication_results.hpp"
+
+#include "genquery_builder.hpp"
+#include "metadata_operations.hpp"
+
+#include <irods/irods_query.hpp>
+#include <irods/rodsLog.h>
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace {
+    // value and units of an existing annotation
+    using existing_values = std::map<std::string, std::vector<std::pair<std::string, std::string>>>;
+
+    // the catalog bounds the length of a query condition, so a list of
+    // names is split into as many lists as keep each under this length
+    constexpr std::size_t max_list_length = 2000;
+
+    std::vector<std::string> quoted_lists(
+        const std::set<std::string>& _values,
+        const std::size_t            _max_length) {
+        std::vector<std::string> lists(1);
+        for(const auto& v : _values) {
+            const auto quoted = "'" + irods::publishing::escape_genquery_literal(v) + "'";
+            if(!lists.back().empty() && lists.back().size() + 2 + quoted.size() > _max_length) {
+                lists.emplace_back();
+            }
+            lists.back() += (lists.back().empty() ? "" : ", ") + quoted;
+        }
+        return lists;
+    } // quoted_lists
+
+    std::string quoted_list(const std::set<std::string>& _values) {
+        return quoted_lists(_values, std::string::npos).front();
+    } // quoted_list
+} // namespace
+
+namespace irods {
+    namespace publishing {
+        publication_results::publication_results(
+            const std::string& _prefix,
+            const std::size_t  _batch_size) :
+              prefix_{_prefix}
+            , batch_size_{std::max<std::size_t>(1, _batch_size)} {
+        } // ctor
+
+        void publication_results::record(
+            const std::string& _path,
+            const bool         _is_collection,
+            const std::string& _attribute,
+            const std::string& _value) {
+            std::lock_guard<std::mutex> lock{mutex_};
+            auto& e = pending_[_path];
+            e.is_collection = _is_collection;
+            e.values[_attribute] = _value;
+        } // record
+
+        void publication_results::flush_if_full(rsComm_t& _comm) {
+            {
+                std::lock_guard<std::mutex> lock{mutex_};
+                if(pending_.size() < batch_size_) {
+                    return;
+                }
+            }
+
+            flush(_comm);
+        } // flush_if_full
+
+        void publication_results::flush(rsComm_t& _comm) {
+            std::map<std::string, entry> batch;
+            {
+                std::lock_guard<std::mutex> lock{mutex_};
+                batch.swap(pending_);
+            }
+
+            if(batch.empty()) {
+                return;
+            }
+
+            // the values a path already carries for the attributes being
+            // written, found with one query per collection in the batch and
+            // limited to the objects of the batch
+            std::map<std::string, std::set<std::string>> names_by_collection;
+            std::map<std::string, std::set<std::string>> attributes_by_collection;
+            for(const auto& b : batch) {
+                const auto slash = b.first.find_last_of('/');
+                const auto collection = b.second.is_collection ?
+                                        b.first :
+                                        b.first.substr(0, slash);
+                for(const auto& v : b.second.values) {
+                    attributes_by_collection[collection].insert(v.first);
+                }
+                if(!b.second.is_collection) {
+                    names_by_collection[collection].insert(b.first.substr(slash + 1));
+                }
+            }
+
+            std::map<std::string, existing_values> existing;
+            try {
+                for(const auto& c : attributes_by_collection) {
+                    const auto attributes = quoted_list(c.second);
+                    if(const auto names = names_by_collection.find(c.first); names != names_by_collection.end()) {
+                        for(const auto& l : quoted_lists(names->second, max_list_length)) {
+                            const auto query_str = boost::str(boost::format(
+                                "SELECT DATA_NAME, META_DATA_ATTR_NAME, META_DATA_ATTR_VALUE, META_DATA_ATTR_UNITS "
+                                "WHERE COLL_NAME = '%s' AND DATA_NAME in (%s) AND META_DATA_ATTR_NAME in (%s)")
+                                % escape_genquery_literal(c.first)
+                                % l
+                                % attributes);
+                            for(const auto& row : irods::query{&_comm, query_str}) {
+                                existing[c.first + "/" + row[0]][row[1]].emplace_back(row[2], row[3]);
+                            }
+                        }
+                    }
+
+                    if(batch.count(c.first) && batch.at(c.first).is_collection) {
+                        const auto query_str = boost::str(boost::format(
+                            "SELECT META_COLL_ATTR_NAME, META_COLL_ATTR_VALUE, META_COLL_ATTR_UNITS "
+                            "WHERE COLL_NAME = '%s' AND META_COLL_ATTR_NAME in (%s)")
+                            % escape_genquery_literal(c.first)
+                            % attributes);
+                        for(const auto& row : irods::query{&_comm, query_str}) {
+                            existing[c.first][row[0]].emplace_back(row[1], row[2]);
+                        }
+                    }
+                }
+            }
+            catch(const std::exception& _e) {
+                rodsLog(
+                    LOG_ERROR,
+                    "failed to list earlier publication results [%s]",
+                    _e.what());
+                return;
+            }
+
+            std::size_t failed{};
+            for(const auto& b : batch) {
+                const auto itr = existing.find(b.first);
+                std::vector<avu_operation> operations;
+                for(const auto& v : b.second.values) {
+                    bool current{};
+                    if(itr != existing.end()) {
+                        if(const auto prior = itr->second.find(v.first); prior != itr->second.end()) {
+                            for(const auto& p : prior->second) {
+                                if(p.first == v.second && p.second.empty()) {
+                                    current = true;
+                                    continue;
+                                }
+                                operations.push_back({"remove", v.first, p.first, p.second});
+                            }
+                        }
+                    }
+
+                    if(!current) {
+                        operations.push_back({"add", v.first, v.second, ""});
+                    }
+                }
+
+                try {
+                    apply_metadata_operations(_comm, b.first, b.second.is_collection, operations);
+                }
+                catch(const std::exception& _e) {
+                    ++failed;
+                    rodsLog(
+                        LOG_ERROR,
+                        "failed to record publication results for [%s] [%s]",
+                        b.first.c_str(),
+                        _e.what());
+                }
+            }
+
+            rodsLog(
+                LOG_DEBUG,
+                "recorded publication results for [%zu] paths, [%zu] failed",
+                batch.size() - failed,
+                failed);
+        } // flush
+    } // namespace publishing
+} // namespace irods
@@ -0,0 +1,55 @@
+#ifndef PUBLICATION_RESULTS_HPP
+#define PUBLICATION_RESULTS_HPP
+
+#include <irods/rcConnect.h>
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace irods {
+    namespace publishing {
+        // the outcome of a publication for each path it published, such as
+        // where an object went and when.  backends record results as objects
+        // complete, from any thread, and the thread owning the connection
+        // writes them out a batch of paths at a time.  each path is written
+        // in one atomic metadata transaction however many results it has,
+        // replacing the values left by an earlier publication
+        class publication_results {
+            public:
+            publication_results(
+                const std::string& _prefix,
+                const std::size_t  _batch_size);
+
+            // the attribute for the result _name
+            std::string attribute(const std::string& _name) const { return prefix_ + _name; }
+
+            void record(
+                const std::string& _path,
+                const bool         _is_collection,
+                const std::string& _attribute,
+                const std::string& _value);
+
+            // write the pending results once a batch of paths has accumulated
+            void flush_if_full(rsComm_t& _comm);
+
+            // write every pending result.  failures are logged, a result is
+            // a record of the publication rather than part of it
+            void flush(rsComm_t& _comm);
+
+            private:
+            struct entry {
+                bool                               is_collection{};
+                std::map<std::string, std::string> values; // attribute to value
+            }; // struct entry
+
+            const std::string            prefix_;
+            const std::size_t            batch_size_;
+            std::mutex                   mutex_;
+            std::map<std::string, entry> pending_;
+        }; // class publication_results
+    } // namespace publishing
+} // namespace irods
+
+#endif // PUBLICATION_RESULTS_HPP
@@ -0,0 +1,167 @@
+#include "published_path_filter.hpp"
+
+#include "pep_dispatch_table.hpp"
+#include "shared_segment.hpp"
+
+#include <boost/format.hpp>
+
+#include <chrono>
+
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace {
+    uint64_t now() noexcept {
+        using namespace std::chrono;
+        return duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+    } // now
+
+    bool agent_exists(const int _pid) noexcept {
+        return _pid > 0 && (0 == ::kill(_pid, 0) || EPERM == errno);
+    } // agent_exists
+
+    // the bits of a path are chosen by double hashing
+    template<typename Function>
+    void for_each_bit(
+        const std::string& _path,
+        Function           _fn) noexcept {
+        using irods::publishing::fnv1a;
+        using irods::publishing::published_path_filter;
+        const auto h1 = fnv1a(_path, 0);
+        const auto h2 = fnv1a(_path, 0x9e3779b9u) | 1u;
+        for(std::size_t i = 0; i < published_path_filter::hash_count; ++i) {
+            _fn((h1 + i * h2) & (published_path_filter::bit_count - 1));
+        }
+    } // for_each_bit
+} // namespace
+
+namespace irods {
+    namespace publishing {
+        published_path_filter::published_path_filter(const std::string& _instance_name) {
+            // the size is part of the name so agents built with a different
+            // layout never share a filter
+            segment_ = static_cast<segment*>(map_shared_segment(
+                           boost::str(boost::format("irods_publishing_paths_%s_%u.shm")
+                           % _instance_name
+                           % sizeof(segment)),
+                           sizeof(segment)));
+        } // ctor
+
+        published_path_filter::~published_path_filter() {
+            unmap_shared_segment(segment_, sizeof(segment));
+        } // dtor
+
+        void published_path_filter::set(
+            bank&              _bank,
+            const std::string& _path) noexcept {
+            for_each_bit(_path, [&](const std::size_t _bit) {
+                _bank[_bit / word_bits].fetch_or(uint64_t{1} << (_bit % word_bits), std::memory_order_relaxed);
+            });
+        } // set
+
+        bool published_path_filter::may_contain(
+            const bank&        _bank,
+            const std::string& _path) noexcept {
+            bool present{true};
+            for_each_bit(_path, [&](const std::size_t _bit) {
+                present = present &&
+                          (_bank[_bit / word_bits].load(std::memory_order_relaxed) &
+                           (uint64_t{1} << (_bit % word_bits)));
+            });
+            return present;
+        } // may_contain
+
+        void published_path_filter::insert(const std::string& _path) noexcept {
+            if(!segment_) {
+                return;
+            }
+
+            // both banks, so a rebuild under way cannot drop the path.  the
+            // rebuild clears its bank before scanning, and the scan sees any
+            // path tagged before the clear
+            for(auto& b : segment_->banks) {
+                set(b, _path);
+            }
+        } // insert
+
+        bool published_path_filter::excludes(
+            const std::string& _path,
+            const path_check   _check) const noexcept {
+            if(path_check::none == _check) {
+                return true;
+            }
+
+            if(!segment_ || 0 == segment_->built_at.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            const auto generation = segment_->generation.load(std::memory_order_acquire);
+            const auto& b = segment_->banks[segment_->active.load(std::memory_order_acquire)];
+            if(path_check::object_and_ancestors == _check && may_contain(b, _path)) {
+                return false;
+            }
+
+            for(auto coll = parent_collection(_path); !coll.empty(); coll = parent_collection(coll)) {
+                if(may_contain(b, coll)) {
+                    return false;
+                }
+            }
+
+            // a rebuild which began meanwhile may have cleared the bank read
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return generation == segment_->generation.load(std::memory_order_relaxed);
+        } // excludes
+
+        bool published_path_filter::stale(const uint64_t _max_age) const noexcept {
+            if(!segment_) {
+                return false;
+            }
+
+            // a clock set back before the build also calls for a rebuild
+            const auto built_at = segment_->built_at.load(std::memory_order_acquire);
+            const auto current  = now();
+            return 0 == built_at || current < built_at || current - built_at > _max_age;
+        } // stale
+
+        bool published_path_filter::rebuild(
+            catalog&           _catalog,
+            const std::string& _attribute) {
+            if(!segment_) {
+                return false;
+            }
+
+            // an agent which died while rebuilding gives up its claim
+            auto builder = segment_->builder.load();
+            if(agent_exists(builder) ||
+               !segment_->builder.compare_exchange_strong(builder, ::getpid())) {
+                return false;
+            }
+
+            struct release {
+                std::atomic<int32_t>& builder;
+                ~release() { builder.store(0); }
+            } released{segment_->builder};
+
+            // readers which chose the idle bank while it was active must see
+            // the generation move before any of its bits are cleared
+            segment_->generation.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            const auto idle = 1 - segment_->active.load(std::memory_order_acquire);
+            auto& b = segment_->banks[idle];
+            for(auto& w : b) {
+                w.store(0, std::memory_order_relaxed);
+            }
+
+            for(const auto& p : _catalog.paths_with_metadata(_attribute)) {
+                set(b, p);
+            }
+
+            segment_->active.store(idle, std::memory_order_release);
+            segment_->generation.fetch_add(1, std::memory_order_release);
+            segment_->built_at.store(now(), std::memory_order_release);
+            return true;
+        } // rebuild
+    } // namespace publishing
+} // namespace irods
@@ -0,0 +1,80 @@
+#ifndef PUBLISHED_PATH_FILTER_HPP
+#define PUBLISHED_PATH_FILTER_HPP
+
+#include "catalog.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace irods {
+    namespace publishing {
+        // a bloom filter of every published collection and object, kept in a
+        // file mapped by every agent on the host.  when neither a path nor any
+        // collection above it is in the filter nothing there can be published
+        // and the immutability check needs no catalog query, only a path the
+        // filter may hold is looked up in the catalog.  paths are added as the
+        // publishing plugin sees them tagged and never removed, so a path no
+        // longer published costs a lookup until the next rebuild, which also
+        // brings in paths tagged through another server.  the filter is built
+        // into the idle of two banks, which then becomes the one read, so a
+        // rebuild never leaves readers with a partial filter.  a reader still
+        // on a bank which a later rebuild starts clearing sees the generation
+        // move and falls back to the catalog
+        class published_path_filter {
+            public:
+            static constexpr std::size_t bit_count  = std::size_t{1} << 23;
+            static constexpr std::size_t hash_count = 7;
+
+            explicit published_path_filter(const std::string& _instance_name);
+            ~published_path_filter();
+
+            published_path_filter(const published_path_filter&) = delete;
+            published_path_filter& operator=(const published_path_filter&) = delete;
+
+            // record a path which has just been published
+            void insert(const std::string& _path) noexcept;
+
+            // true when the filter shows that none of what _check covers of
+            // _path is published, false when some of it may be or the filter
+            // has never been built
+            bool excludes(
+                const std::string& _path,
+                const path_check   _check) const noexcept;
+
+            // true when the filter was built more than _max_age seconds ago,
+            // or never
+            bool stale(const uint64_t _max_age) const noexcept;
+
+            // rebuild the filter from a single scan for every path carrying
+            // _attribute.  returns false without scanning when another agent
+            // is already rebuilding it
+            bool rebuild(
+                catalog&           _catalog,
+                const std::string& _attribute);
+
+            private:
+            static constexpr std::size_t word_bits  = 64;
+            static constexpr std::size_t word_count = bit_count / word_bits;
+
+            using bank = std::atomic<uint64_t>[word_count];
+
+            struct segment {
+                std::atomic<uint32_t> active;   // the bank read
+                std::atomic<int32_t>  builder;  // pid of the agent rebuilding, zero when none
+                std::atomic<uint64_t> built_at; // seconds since the epoch, zero until built
+                std::atomic<uint64_t> generation; // advanced as a rebuild starts and again as it swaps banks
+                bank                  banks[2];
+            }; // struct segment
+
+            static void set(bank& _bank, const std::string& _path) noexcept;
+
+            static bool may_contain(const bank& _bank, const std::string& _path) noexcept;
+
+            segment* segment_{};
+        }; // class published_path_filter
+    } // namespace publishing
+} // namespace irods
+
+#endif // PUBLISHED_PATH_FILTER_HPP
@@ -25,6 +25,16 @@ add_library(
     ${CMAKE_SOURCE_DIR}/plugin_specific_configuration.cpp
     ${CMAKE_SOURCE_DIR}/utilities.cpp
     ${CMAKE_SOURCE_DIR}/publishing_utilities.cpp
+    ${CMAKE_SOURCE_DIR}/job_slot.cpp
+    ${CMAKE_SOURCE_DIR}/publishing_backend.cpp
+    ${CMAKE_SOURCE_DIR}/fingerprint.cpp
+    ${CMAKE_SOURCE_DIR}/genquery_catalog.cpp
+    ${CMAKE_SOURCE_DIR}/pep_metrics.cpp
+    ${CMAKE_SOURCE_DIR}/shared_segment.cpp
+    ${CMAKE_SOURCE_DIR}/job_table.cpp
+    ${CMAKE_SOURCE_DIR}/published_path_filter.cpp
+    ${CMAKE_SOURCE_DIR}/metadata_operations.cpp
+    ${CMAKE_SOURCE_DIR}/publication_results.cpp
     )
 
 target_include_directories(
@@ -45,6 +55,7 @@ target_link_libraries(
     ${IRODS_EXTERNALS_FULLPATH_FMT}/lib/libfmt.so
     irods_common
     nlohmann_json::nlohmann_json
+    ${CMAKE_DL_LIBS}
     )
 
 target_compile_definitions(${TARGET_NAME} PRIVATE ${IRODS_PLUGIN_POLICY_COMPILE_DEFINITIONS} ${IRODS_COMPILE_DEFINITIONS} ${IRODS_COMPILE_DEFINITIONS_PRIVATE} BOOST_SYSTEM_NO_DEPRECATED)
@@ -67,6 +78,14 @@ install(
   COMPONENT ${IRODS_PACKAGE_COMPONENT_POLICY_NAME}
   )
 
+install(
+  FILES
+  ${CMAKE_SOURCE_DIR}/packaging/mock_dataworld_server.py
+  DESTINATION ${IRODS_HOME_DIRECTORY}/scripts/irods/test
+  PERMISSIONS OWNER_READ OWNER_WRITE GROUP_READ WORLD_READ
+  COMPONENT ${IRODS_PACKAGE_COMPONENT_POLICY_NAME}
+  )
+
 install(
   FILES
   ${CMAKE_SOURCE_DIR}/packaging/run_publishing_plugin_test.py
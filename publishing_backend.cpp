@@ -0,0 +1,122 @@
+#include "publishing_backend.hpp"
+
+#include <irods/irods_load_plugin.hpp>
+#include <irods/irods_configuration_keywords.hpp>
+#include <irods/rodsLog.h>
+
+#include <dlfcn.h>
+
+namespace {
+    const std::string plugin_name_prefix{"libirods_rule_engine_plugin-"};
+    const std::string lookup_symbol{"irods_publishing_find_backend"};
+} // namespace
+
+namespace irods {
+    namespace publishing {
+        backend_registry& backend_registry::instance() {
+            static backend_registry registry;
+            return registry;
+        } // instance
+
+        void backend_registry::add(
+            const std::string& _service,
+            backend*           _backend) {
+            std::lock_guard<std::mutex> lock{mutex_};
+            backends_[_service] = _backend;
+        } // add
+
+        void backend_registry::remove(
+            const std::string& _service) {
+            std::lock_guard<std::mutex> lock{mutex_};
+            backends_.erase(_service);
+            resolved_.erase(_service);
+        } // remove
+
+        backend* backend_registry::find(
+            const std::string& _service) {
+            {
+                std::lock_guard<std::mutex> lock{mutex_};
+                if(const auto itr = backends_.find(_service); itr != backends_.end()) {
+                    return itr->second;
+                }
+
+                // a backend found earlier is used while the module holding it
+                // is still loaded, a reloaded module may be mapped elsewhere,
+                // and while its plugin has not removed it on stop
+                if(const auto itr = resolved_.find(_service); itr != resolved_.end()) {
+                    void* handle = dlopen(itr->second.so_name.c_str(), RTLD_LAZY | RTLD_NOLOAD);
+                    if(handle) {
+                        dlclose(handle);
+                    }
+
+                    if(handle && handle == itr->second.handle &&
+                       itr->second.lookup(_service.c_str()) == itr->second.be) {
+                        return itr->second.be;
+                    }
+
+                    resolved_.erase(itr);
+                }
+            }
+
+            // resolve without holding the lock, the lookup may land in this module.
+            // misses are not cached, the backend plugin may yet be started
+            auto r = find_in_plugin(_service);
+            if(!r.be) {
+                return nullptr;
+            }
+
+            std::lock_guard<std::mutex> lock{mutex_};
+            resolved_[_service] = r;
+            return r.be;
+        } // find
+
+        void backend_registry::clear_resolved() {
+            std::lock_guard<std::mutex> lock{mutex_};
+            resolved_.clear();
+        } // clear_resolved
+
+        backend* backend_registry::find_local(
+            const std::string& _service) {
+            std::lock_guard<std::mutex> lock{mutex_};
+            const auto itr = backends_.find(_service);
+            return itr != backends_.end() ? itr->second : nullptr;
+        } // find_local
+
+        backend_registry::resolution backend_registry::find_in_plugin(
+            const std::string& _service) {
+            std::string plugin_home;
+            irods::error err = irods::resolve_plugin_path(
+                                   irods::KW_CFG_PLUGIN_TYPE_RULE_ENGINE,
+                                   plugin_home);
+            if(!err.ok()) {
+                return {};
+            }
+
+            resolution r;
+            r.so_name = plugin_home + plugin_name_prefix + _service + ".so";
+
+            // only consider plugins the server has already loaded and started
+            r.handle = dlopen(r.so_name.c_str(), RTLD_LAZY | RTLD_NOLOAD);
+            if(!r.handle) {
+                rodsLog(
+                    LOG_DEBUG,
+                    "irods::publishing no native backend loaded for [%s], using rule dispatch",
+                    _service.c_str());
+                return {};
+            }
+
+            r.lookup = reinterpret_cast<lookup_type>(dlsym(r.handle, lookup_symbol.c_str()));
+            r.be     = r.lookup ? r.lookup(_service.c_str()) : nullptr;
+
+            // the server holds its own reference to the plugin
+            dlclose(r.handle);
+
+            return r;
+        } // find_in_plugin
+    } // namespace publishing
+} // namespace irods
+
+extern "C" irods::publishing::backend* irods_publishing_find_backend(const char* _service) {
+    auto& registry = irods::publishing::backend_registry::instance();
+    return registry.find_local(_service);
+} // irods_publishing_find_backend
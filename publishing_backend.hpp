@@ -0,0 +1,106 @@
+#ifndef PUBLISHING_BACKEND_HPP
+#define PUBLISHING_BACKEND_HPP
+
+#include <irods/irods_re_plugin.hpp>
+
+#include "pipeline_metrics.hpp"
+#include "publication_results.hpp"
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace irods {
+    namespace publishing {
+        // polled by a backend between objects, and between the chunks of an
+        // object where it streams them.  once it returns true the backend
+        // stops uploading and returns, leaving the framework to purge
+        using cancellation_check = std::function<bool()>;
+
+        inline bool cancellation_requested(const cancellation_check& _check) {
+            return _check && _check();
+        } // cancellation_requested
+
+        // everything a backend needs to carry out a single publication job
+        struct job {
+            ruleExecInfo_t* rei{};
+            std::string     path;
+            std::string     user_name;
+            std::string     publish_type;
+            // timing of the job, null when the framework is not collecting it
+            pipeline_metrics* metrics{};
+            // empty when the job may not be cancelled
+            cancellation_check cancelled;
+            // where the outcome of each published path is recorded, null when
+            // the framework is not recording results
+            publication_results* results{};
+        }; // struct job
+
+        // native interface for a publication service, called in process by the
+        // framework rather than through a rule engine dispatch
+        class backend {
+            public:
+            virtual ~backend() = default;
+
+            virtual void publish_object(const job& _job) = 0;
+            virtual void purge_object(const job& _job) = 0;
+            virtual void publish_collection(const job& _job) = 0;
+            virtual void purge_collection(const job& _job) = 0;
+
+            // bring the remote dataset in line with the collection using the
+            // fewest uploads and deletions
+            virtual void reconcile_collection(const job& _job) = 0;
+        }; // class backend
+
+        // each plugin module carries its own registry.  backends add themselves
+        // in start(), the framework finds them by resolving the exported lookup
+        // function of the already loaded backend plugin, falling back to rule
+        // dispatch for services implemented in a rule language
+        class backend_registry {
+            public:
+            static backend_registry& instance();
+
+            void add(
+                const std::string& _service,
+                backend*           _backend);
+
+            void remove(
+                const std::string& _service);
+
+            backend* find(
+                const std::string& _service);
+
+            // only the backends which were added to this module
+            backend* find_local(
+                const std::string& _service);
+
+            // forget the backends resolved in other modules, called when the
+            // plugin holding this registry stops
+            void clear_resolved();
+
+            private:
+            using lookup_type = backend* (*)(const char*);
+
+            // a backend found in another plugin, the module holding it and
+            // the lookup it exports
+            struct resolution {
+                std::string so_name;
+                void*       handle{};
+                lookup_type lookup{};
+                backend*    be{};
+            }; // struct resolution
+
+            resolution find_in_plugin(
+                const std::string& _service);
+
+            std::mutex                        mutex_;
+            std::map<std::string, backend*>   backends_;
+            std::map<std::string, resolution> resolved_;
+        }; // class backend_registry
+    } // namespace publishing
+} // namespace irods
+
+extern "C" irods::publishing::backend* irods_publishing_find_backend(const char* _service);
+
+#endif // PUBLISHING_BACKEND_HPP
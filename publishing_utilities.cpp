@@ -3,7 +3,9 @@
 #include <irods/irods_re_plugin.hpp>
 #include "utilities.hpp"
 #include "publishing_utilities.hpp"
-#include <irods/irods_query.hpp>
+#include "genquery_catalog.hpp"
+#include "pipeline_metrics.hpp"
+#include "shared_segment.hpp"
 #include <irods/irods_virtual_path.hpp>
 
 #include <irods/rsExecMyRule.hpp>
@@ -12,9 +14,6 @@
 #include <irods/rsCloseCollection.hpp>
 #include <irods/rsModAVUMetadata.hpp>
 
-#define IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
-#include <irods/filesystem.hpp>
-
 #include <boost/any.hpp>
 #include <boost/regex.hpp>
 #include <boost/exception/all.hpp>
@@ -22,6 +21,12 @@
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
 #include <random>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
 
 #include <nlohmann/json.hpp>
 
@@ -32,6 +37,74 @@ int _delayExec(
     const char *delayCondition,
     ruleExecInfo_t *rei );
 
+namespace {
+    template<typename T>
+    T to_integer(const std::string& _value, const T _default) {
+        try {
+            return boost::lexical_cast<T>(_value);
+        }
+        catch(const boost::bad_lexical_cast&) {
+            return _default;
+        }
+    } // to_integer
+
+    std::mt19937& prng() {
+        thread_local std::mt19937 gen{std::random_device{}()};
+        return gen;
+    } // prng
+
+    // the publishing delay queue as last sampled from the catalog, kept in a
+    // file mapped by every agent on the host.  agents are forked for each
+    // connection, so a per process sample would rarely be reused and could
+    // never see the jobs other agents submitted.  the agent which advances
+    // sampled_at takes the next sample, the others use the one in place
+    struct queue_sample {
+        std::atomic<uint64_t> sampled_at;            // microseconds since the epoch, zero until sampled
+        std::atomic<uint64_t> depth;
+        std::atomic<uint64_t> enqueued_since_sample;
+        std::atomic<uint64_t> completion_rate;       // bits of a double, jobs per second, smoothed
+    }; // struct queue_sample
+
+    uint64_t microseconds_now() noexcept {
+        using namespace std::chrono;
+        return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+    } // microseconds_now
+
+    double load_rate(const queue_sample& _q) noexcept {
+        const uint64_t bits = _q.completion_rate.load(std::memory_order_relaxed);
+        double rate{};
+        std::memcpy(&rate, &bits, sizeof(rate));
+        return rate;
+    } // load_rate
+
+    void store_rate(queue_sample& _q, const double _rate) noexcept {
+        uint64_t bits{};
+        std::memcpy(&bits, &_rate, sizeof(bits));
+        _q.completion_rate.store(bits, std::memory_order_relaxed);
+    } // store_rate
+
+    queue_sample& delay_queue(const std::string& _instance_name) {
+        // mapped once by each agent and left mapped until it exits.  should
+        // the map fail the agent keeps a sample of its own
+        static std::mutex                            mutex;
+        static std::map<std::string, queue_sample*> samples;
+        static queue_sample                          unshared{};
+
+        std::lock_guard<std::mutex> lock{mutex};
+        auto it = samples.find(_instance_name);
+        if(samples.end() == it) {
+            auto segment = static_cast<queue_sample*>(irods::publishing::map_shared_segment(
+                               boost::str(boost::format("irods_publishing_queue_%s_%u.shm")
+                               % _instance_name
+                               % sizeof(queue_sample)),
+                               sizeof(queue_sample)));
+            it = samples.emplace(_instance_name, segment ? segment : &unshared).first;
+        }
+
+        return *it->second;
+    } // delay_queue
+} // namespace
+
 namespace irods {
     namespace publishing {
         publisher::publisher(
@@ -39,7 +112,18 @@ namespace irods {
             const std::string& _instance_name) :
               rei_(_rei)
             , comm_(_rei->rsComm)
-            , config_(_instance_name) {
+            , config_(_instance_name)
+            , catalog_(std::make_shared<genquery_catalog>(_rei->rsComm)) {
+        } // publisher
+
+        publisher::publisher(
+            ruleExecInfo_t*          _rei,
+            const std::string&       _instance_name,
+            std::shared_ptr<catalog> _catalog) :
+              rei_(_rei)
+            , comm_(_rei->rsComm)
+            , config_(_instance_name)
+            , catalog_(std::move(_catalog)) {
         } // publisher
 
         void publisher::schedule_publishing_policy(
@@ -63,19 +147,9 @@ namespace irods {
             const std::string& _value,
             const std::string& _units ) {
             try {
-                std::string query_str {
-                    boost::str(
-                            boost::format("SELECT META_COLL_ATTR_VALUE, META_COLL_ATTR_UNITS WHERE META_COLL_ATTR_NAME = '%s' and COLL_NAME = '%s'") %
-                            _attribute %
-                            _collection_name) };
-                query<rsComm_t> qobj{rei_->rsComm, query_str, 1};
-                if(qobj.size() == 0) {
-                    return false;
-                }
-
-                for(auto results : qobj) {
-                    if(results[0] == _value &&
-                       results[1] == _units) {
+                for(const auto& results : catalog_->collection_metadata(_collection_name, _attribute)) {
+                    if(results.first == _value &&
+                       results.second == _units) {
                         return true;
                     }
                 }
@@ -93,26 +167,10 @@ namespace irods {
             const std::string& _attribute,
             const std::string& _value,
             const std::string& _units ) {
-            namespace fs = irods::experimental::filesystem;
             try {
-                fs::path p{_object_path};
-                std::string coll_name = p.parent_path().string();
-                std::string data_name = p.object_name().string();
-
-                std::string query_str {
-                    boost::str(
-                            boost::format("SELECT META_DATA_ATTR_VALUE, META_DATA_ATTR_UNITS WHERE META_DATA_ATTR_NAME = '%s' and COLL_NAME = '%s' and DATA_NAME = '%s'")
-                            % _attribute
-                            % coll_name
-                            % data_name) };
-                query<rsComm_t> qobj{rei_->rsComm, query_str, 1};
-                if(qobj.size() == 0) {
-                    return false;
-                }
-
-                for(auto results : qobj) {
-                    if(results[0] == _value &&
-                       results[1] == _units) {
+                for(const auto& results : catalog_->object_metadata(_object_path, _attribute)) {
+                    if(results.first == _value &&
+                       results.second == _units) {
                         return true;
                     }
                 }
@@ -126,63 +184,46 @@ namespace irods {
         } // metadata_exists_on_object
 
         bool publisher::publishing_metadata_exists_in_path(
-            const std::string& _path) {
-            namespace fs   = irods::experimental::filesystem;
-            namespace fsvr = irods::experimental::filesystem::server;
-            rsComm_t& comm = *rei_->rsComm;
+            const std::string& _path,
+            const path_check   _check) {
+            // a path which cannot be checked is not taken to be mutable
             try {
-                fs::path full_path{_path};
-
-                if(fsvr::is_data_object(comm, full_path) &&
-                   object_is_published(_path)) {
-                    return true;
-                }
-                else if(collection_is_published(_path)) {
-                    return true;
-                }
-
-                auto coll = full_path.parent_path();
-                while(!coll.empty()) {
-                    try {
-                        if(collection_is_published(coll.string())) {
-                            return true;
-                        }
-
-                        coll = coll.parent_path();
-                    }
-                    catch(const std::exception& _e) {
-                        rodsLog(
-                            LOG_ERROR,
-                            "publishing_metadata_exists_in_path failed [%s]",
-                            _e.what());
-                    }
-                    catch(const irods::exception& _e) {
-                        rodsLog(
-                            LOG_ERROR,
-                            "publishing_metadata_exists_in_path failed [%s]",
-                            _e.what());
-                    }
-
-                } // while
-
-                return false;
+                return attribute_exists_in_path(*catalog_, _path, config_.publish, _check);
+            }
+            catch(const irods::exception& _e) {
+                THROW(
+                    _e.code(),
+                    boost::format("publishing_metadata_exists_in_path failed [%s]")
+                    % _e.client_display_what());
             }
             catch(const std::exception& _e) {
-                rodsLog(
-                    LOG_ERROR,
-                    "publishing_metadata_exists_in_path failed [%s]",
-                    _e.what());
+                THROW(
+                    SYS_INTERNAL_ERR,
+                    boost::format("publishing_metadata_exists_in_path failed [%s]")
+                    % _e.what());
+            }
+        } // publishing_metadata_exists_in_path
+
+        std::string publisher::published_object_in_paths(
+            const std::vector<std::string>& _object_paths,
+            const path_check                _check) {
+            // an object which cannot be checked is not taken to be mutable
+            try {
+                return object_with_attribute_in_paths(*catalog_, _object_paths, config_.publish, _check);
             }
             catch(const irods::exception& _e) {
-                rodsLog(
-                    LOG_ERROR,
-                    "publishing_metadata_exists_in_path failed [%s]",
-                    _e.what());
+                THROW(
+                    _e.code(),
+                    boost::format("published_object_in_paths failed [%s]")
+                    % _e.client_display_what());
             }
-
-            return false;
-
-        } // publishing_metadata_exists_in_path
+            catch(const std::exception& _e) {
+                THROW(
+                    SYS_INTERNAL_ERR,
+                    boost::format("published_object_in_paths failed [%s]")
+                    % _e.what());
+            }
+        } // published_object_in_paths
 
         void publisher::schedule_collection_publishing_event(
             const std::string& _collection_name,
@@ -195,47 +236,91 @@ namespace irods {
                 _collection_name.c_str(),
                 _publisher.c_str());
 
-            using json = nlohmann::json;
-            json rule_obj;
-            rule_obj["rule-engine-operation"]     = policy::collection::publish;
-            rule_obj["rule-engine-instance-name"] = config_.instance_name_;
-            rule_obj["collection-name"]           = _collection_name;
-            rule_obj["user-name"]                 = _user_name;
-            rule_obj["publisher"]                 = _publisher;
-            rule_obj["publish-type"]              = publish_type::collection;
+            const auto estimate = estimate_collection_size(_collection_name);
+            const auto lane     = select_lane(estimate);
+
+            schedule_policy_event_for_collection(
+                policy::collection::publish,
+                _collection_name,
+                _user_name,
+                _publisher,
+                estimate,
+                lane,
+                generate_delay_execution_parameters(lane));
+        } // schedule_collection_publishing_event
 
-            const auto delay_err = _delayExec(
-                                       rule_obj.dump().c_str(),
-                                       "",
-                                       generate_delay_execution_parameters().c_str(),
-                                       rei_);
-            if(delay_err < 0) {
-                THROW(
-                    delay_err,
-                    boost::format("queue collection publishing failed for [%s] publisher [%s]") %
-                    _collection_name %
-                    _publisher);
+        void publisher::schedule_collection_reconcile_event(
+            const std::string& _collection_name,
+            const std::string& _publisher,
+            const std::string& _user_name) {
+            // reconciliation may touch every object, so it shares the publish lane
+            const auto estimate = estimate_collection_size(_collection_name);
+            const auto lane     = select_lane(estimate);
+
+            schedule_policy_event_for_collection(
+                policy::collection::reconcile,
+                _collection_name,
+                _user_name,
+                _publisher,
+                estimate,
+                lane,
+                generate_delay_execution_parameters(lane));
+        } // schedule_collection_reconcile_event
+
+        void publisher::schedule_collection_purging_event(
+            const std::string& _collection_name,
+            const std::string& _publisher,
+            const std::string& _user_name) {
+            // a purge only removes remote datasets, it is always a small job
+            schedule_policy_event_for_collection(
+                policy::collection::purge,
+                _collection_name,
+                _user_name,
+                _publisher,
+                job_size_estimate{},
+                lane::small,
+                generate_delay_execution_parameters(lane::small));
+        } // schedule_collection_purging_event
+
+        void publisher::schedule_object_purging_event(
+            const std::string& _object_path,
+            const std::string& _user_name,
+            const std::string& _publisher) {
+            try {
+                schedule_policy_event_for_object(
+                    policy::object::purge,
+                    _object_path,
+                    _user_name,
+                    _publisher,
+                    publish_type::object,
+                    job_size_estimate{},
+                    lane::small,
+                    generate_delay_execution_parameters(lane::small));
             }
-
-        rodsLog(
-            config_.log_level,
-            "irods::publishing::collection publishing collection [%s] with [%s]",
-            _collection_name.c_str(),
-            _publisher.c_str());
-        } // schedule_collection_publishing_event
+            catch(const irods::exception& _e) {
+                rodsLog(
+                    LOG_ERROR,
+                    "failed [%s]",
+                    _e.what());
+            }
+        } // schedule_object_purging_event
 
         void publisher::schedule_object_publishing_event(
             const std::string& _object_path,
             const std::string& _user_name,
             const std::string& _publisher) {
             try {
+                const auto estimate = estimate_object_size(_object_path);
+                const auto lane     = select_lane(estimate);
                 schedule_policy_event_for_object(
                     policy::object::publish,
                     _object_path,
                     _user_name,
                     _publisher,
                     publish_type::object,
-                    generate_delay_execution_parameters());
+                    estimate,
+                    lane,
+                    generate_delay_execution_parameters(lane));
             }
             catch(const irods::exception& _e) {
                 rodsLog(
@@ -245,37 +330,165 @@ namespace irods {
             }
         } // schedule_object_publishing_event
 
-        std::string publisher::generate_delay_execution_parameters() {
-            std::string params{config_.delay_parameters + "<INST_NAME>" + config_.instance_name_ + "</INST_NAME>"};
-
-            int min_time{1};
+        job_size_estimate publisher::estimate_object_size(
+            const std::string& _object_path) {
+            job_size_estimate estimate{0, 1};
             try {
-                min_time = boost::lexical_cast<int>(config_.minimum_delay_time);
+                estimate.bytes = catalog_->data_object_size(_object_path);
+            }
+            catch(const std::exception& _e) {
+                rodsLog(
+                    LOG_ERROR,
+                    "estimate_object_size failed [%s]",
+                    _e.what());
             }
-            catch(const boost::bad_lexical_cast&) {}
 
-            int max_time{30};
+            return estimate;
+        } // estimate_object_size
+
+        job_size_estimate publisher::estimate_collection_size(
+            const std::string& _collection_name) {
+            job_size_estimate estimate{};
             try {
-                max_time = boost::lexical_cast<int>(config_.maximum_delay_time);
+                estimate = catalog_->collection_size(_collection_name);
+            }
+            catch(const irods::exception& _e) {
+                rodsLog(
+                    LOG_ERROR,
+                    "estimate_collection_size failed [%s]",
+                    _e.client_display_what());
+            }
+            catch(const std::exception& _e) {
+                rodsLog(
+                    LOG_ERROR,
+                    "estimate_collection_size failed [%s]",
+                    _e.what());
+            }
+
+            return estimate;
+        } // estimate_collection_size
+
+        std::string publisher::select_lane(
+            const job_size_estimate& _estimate) {
+            const auto max_bytes   = to_integer<uintmax_t>(config_.small_job_maximum_bytes, 104857600);
+            const auto max_objects = to_integer<uintmax_t>(config_.small_job_maximum_objects, 32);
+            if(_estimate.bytes <= max_bytes && _estimate.objects <= max_objects) {
+                return lane::small;
+            }
+
+            return lane::bulk;
+        } // select_lane
+
+        int publisher::lane_maximum_concurrency(
+            const std::string& _lane) {
+            if(lane::bulk == _lane) {
+                return to_integer<int>(config_.bulk_job_maximum_concurrency, 2);
+            }
+
+            // the small lane is never throttled
+            return 0;
+        } // lane_maximum_concurrency
+
+        uintmax_t publisher::sample_delay_queue_depth(
+            double& _completion_rate) {
+            auto& q = delay_queue(config_.instance_name_);
+
+            const auto now      = microseconds_now();
+            const auto interval = static_cast<uint64_t>(
+                                      std::max(0, to_integer<int>(config_.queue_sample_interval, 10))) * 1000000;
+            auto sampled_at = q.sampled_at.load();
+            if((0 != sampled_at && now >= sampled_at && now - sampled_at < interval) ||
+               !q.sampled_at.compare_exchange_strong(sampled_at, now)) {
+                // recent enough, or another agent is taking the next sample
+                _completion_rate = load_rate(q);
+                return q.depth.load() + q.enqueued_since_sample.load();
             }
-            catch(const boost::bad_lexical_cast&) {}
 
-            std::string sleep_time{"1"};
+            uintmax_t depth{};
             try {
-                std::random_device rd;
-                std::mt19937 gen(rd());
-                std::uniform_int_distribution<> dis(min_time, max_time);
-                sleep_time = boost::lexical_cast<std::string>(dis(gen));
+                depth = catalog_->count_delayed_rules(policy::prefix);
+            }
+            catch(const irods::exception& _e) {
+                rodsLog(
+                    LOG_ERROR,
+                    "sample_delay_queue_depth failed [%s]",
+                    _e.what());
+                _completion_rate = load_rate(q);
+                return q.depth.load();
+            }
+
+            // jobs which left the queue since the last sample, less those added
+            const auto enqueued = q.enqueued_since_sample.exchange(0);
+            if(0 != sampled_at && now > sampled_at) {
+                const double elapsed = static_cast<double>(now - sampled_at) / 1000000.0;
+                const double drained = static_cast<double>(q.depth.load() + enqueued) -
+                                       static_cast<double>(depth);
+                store_rate(q, 0.5 * load_rate(q) + 0.5 * std::max(0.0, drained) / elapsed);
+            }
+
+            q.depth.store(depth);
+
+            _completion_rate = load_rate(q);
+            return depth;
+        } // sample_delay_queue_depth
+
+        std::string publisher::generate_delay_execution_parameters(
+            const std::string& _lane) {
+            std::string params{config_.delay_parameters + "<INST_NAME>" + config_.instance_name_ + "</INST_NAME>"};
+
+            const bool small = lane::small == _lane;
+
+            const int min_time = small ?
+                                 to_integer<int>(config_.small_job_minimum_delay_time, 0) :
+                                 to_integer<int>(config_.minimum_delay_time, 1);
+            const int max_time = std::max(min_time, small ?
+                                 to_integer<int>(config_.small_job_maximum_delay_time, 1) :
+                                 to_integer<int>(config_.maximum_delay_time, 30));
+            const std::string priority = small ?
+                                         config_.small_job_priority :
+                                         config_.bulk_job_priority;
+
+            int lower{min_time};
+            int upper{max_time};
+            uintmax_t depth{};
+            double    rate{};
+            if(!small) {
+                // the small lane keeps its fixed window, bulk jobs adapt to the queue:
+                // start when the backlog should have drained and spread the start
+                // times in proportion to the depth to avoid a thundering herd
+                depth = sample_delay_queue_depth(rate);
+                if(0 == depth) {
+                    lower = 0;
+                    upper = 1;
+                }
+                else {
+                    const double drain = rate > 0 ?
+                                         static_cast<double>(depth) / rate :
+                                         static_cast<double>(depth);
+                    lower = static_cast<int>(std::min<double>(max_time, drain));
+                    upper = static_cast<int>(std::min<uintmax_t>(max_time, lower + std::max<uintmax_t>(depth, 1)));
+                    upper = std::max(upper, lower);
+                }
             }
-            catch(const boost::bad_lexical_cast&) {}
+
+            std::uniform_int_distribution<> dis(lower, upper);
+            const std::string sleep_time{std::to_string(dis(prng()))};
 
             params += "<PLUSET>"+sleep_time+"s</PLUSET>";
+            params += "<PRIORITY>"+priority+"</PRIORITY>";
+
+            if(!small) {
+                delay_queue(config_.instance_name_).enqueued_since_sample.fetch_add(1);
+            }
 
             rodsLog(
                 config_.log_level,
-                "irods::storage_tiering :: delay params min [%d] max [%d] computed [%s]",
-                min_time,
-                max_time,
+                "irods::publishing :: delay params lane [%s] depth [%ju] rate [%f] window [%d, %d] computed [%s]",
+                _lane.c_str(),
+                depth,
+                rate,
+                lower,
+                upper,
                 params.c_str());
 
             return params;
@@ -284,94 +497,40 @@ namespace irods {
 
         bool publisher::object_is_published(
             const std::string& _object_path) {
-            boost::filesystem::path p{_object_path};
-            std::string coll_name = p.parent_path().string();
-            std::string data_name = p.filename().string();
-
-            std::string query_str {
-                boost::str(boost::format(
-                "SELECT META_DATA_ATTR_VALUE WHERE META_DATA_ATTR_NAME = '%s' and DATA_NAME = '%s' AND COLL_NAME = '%s'")
-                        % config_.publish
-                        % data_name
-                        % coll_name)};
             try {
-                query<rsComm_t> qobj{comm_, query_str, 1};
-                if(qobj.size() == 0) {
-                    return false;
-                }
+                return !catalog_->object_metadata(_object_path, config_.publish).empty();
             }
-            catch(const std::exception&) {
+            catch(const irods::exception&) {
                 return false;
             }
-            catch(const irods::exception&) {
+            catch(const std::exception&) {
                 return false;
             }
-
-            return true;
         } // object_is_published
 
         bool publisher::collection_is_published(
             const std::string& _collection_name) {
-            std::string query_str {
-                boost::str(boost::format(
-                "SELECT META_COLL_ATTR_VALUE WHERE META_COLL_ATTR_NAME = '%s' and COLL_NAME = '%s'")
-                        % config_.publish
-                        % _collection_name)};
             try {
-                query<rsComm_t> qobj{comm_, query_str, 1};
-                if(qobj.size() == 0) {
-                    return false;
-                }
+                return !catalog_->collection_metadata(_collection_name, config_.publish).empty();
             }
-            catch(const std::exception&) {
+            catch(const irods::exception&) {
                 return false;
             }
-            catch(const irods::exception&) {
+            catch(const std::exception&) {
                 return false;
             }
-
-            return true;
         } // collection_is_published
 
         publisher::metadata_results publisher::get_metadata_for_data_object(
             const std::string& _object_path,
             const std::string& _meta_attr_name) {
-            boost::filesystem::path p{_object_path};
-            std::string coll_name = p.parent_path().string();
-            std::string data_name = p.filename().string();
-
-            std::string query_str {
-                boost::str(boost::format(
-                "SELECT META_DATA_ATTR_VALUE, META_DATA_ATTR_UNITS WHERE META_DATA_ATTR_NAME = '%s' and DATA_NAME = '%s' AND COLL_NAME = '%s'")
-                % _meta_attr_name
-                % data_name
-                % coll_name) };
-            query<rsComm_t> qobj{comm_, query_str};
-
-            metadata_results ret_val;
-            for(const auto& row : qobj) {
-                ret_val.push_back(std::make_pair(row[0], row[1]));
-            }
-
-            return ret_val;
+            return catalog_->object_metadata(_object_path, _meta_attr_name);
         } // get_metadata_for_data_object
 
         publisher::metadata_results publisher::get_metadata_for_collection(
-            const std::string& _meta_attr_name,
-            const std::string& _collection) {
-            std::string query_str {
-                boost::str(boost::format(
-                "SELECT META_COLL_ATTR_VALUE, META_COLL_ATTR_UNITS WHERE META_COLL_ATTR_NAME = '%s' and COLL_NAME = '%s'")
-                % _meta_attr_name
-                % _collection) };
-            query<rsComm_t> qobj{comm_, query_str, 1};
-
-            metadata_results ret_val;
-            for(const auto& row : qobj) {
-                ret_val.push_back(std::make_pair(row[0], row[1]));
-            }
-
-            return ret_val;
+            const std::string& _collection_name,
+            const std::string& _meta_attr_name) {
+            return catalog_->collection_metadata(_collection_name, _meta_attr_name);
         } // get_metadata_for_collection
 
         void publisher::schedule_policy_event_for_object(
@@ -380,6 +539,8 @@ namespace irods {
             const std::string& _user_name,
             const std::string& _publisher,
             const std::string& _publish_type,
+            const job_size_estimate& _estimate,
+            const std::string& _lane,
             const std::string& _data_movement_params) {
             using json = nlohmann::json;
             json rule_obj;
@@ -389,6 +550,10 @@ namespace irods {
             rule_obj["user-name"]                 = _user_name;
             rule_obj["publisher"]                 = _publisher;
             rule_obj["publish-type"]              = _publish_type;
+            rule_obj["estimated-size"]            = _estimate.bytes;
+            rule_obj["estimated-object-count"]    = _estimate.objects;
+            rule_obj["lane"]                      = _lane;
+            rule_obj["tagged-at"]                 = pipeline_metrics::now();
 
             const auto delay_err = _delayExec(
                                        rule_obj.dump().c_str(),
@@ -412,6 +577,50 @@ namespace irods {
                 _publish_type.c_str());
 
         } // schedule_policy_event_for_object
+
+        void publisher::schedule_policy_event_for_collection(
+            const std::string&       _event,
+            const std::string&       _collection_name,
+            const std::string&       _user_name,
+            const std::string&       _publisher,
+            const job_size_estimate& _estimate,
+            const std::string&       _lane,
+            const std::string&       _params) {
+            using json = nlohmann::json;
+            json rule_obj;
+            rule_obj["rule-engine-operation"]     = _event;
+            rule_obj["rule-engine-instance-name"] = config_.instance_name_;
+            rule_obj["collection-name"]           = _collection_name;
+            rule_obj["user-name"]                 = _user_name;
+            rule_obj["publisher"]                 = _publisher;
+            rule_obj["publish-type"]              = publish_type::collection;
+            rule_obj["estimated-size"]            = _estimate.bytes;
+            rule_obj["estimated-object-count"]    = _estimate.objects;
+            rule_obj["lane"]                      = _lane;
+            rule_obj["tagged-at"]                 = pipeline_metrics::now();
+
+            const auto delay_err = _delayExec(
+                                       rule_obj.dump().c_str(),
+                                       "",
+                                       _params.c_str(),
+                                       rei_);
+            if(delay_err < 0) {
+                THROW(
+                    delay_err,
+                    boost::format("queue collection event [%s] failed for [%s] publisher [%s]") %
+                    _event %
+                    _collection_name %
+                    _publisher);
+            }
+
+            rodsLog(
+                config_.log_level,
+                "irods::publishing::publisher event [%s] collection [%s] with [%s] lane [%s]",
+                _event.c_str(),
+                _collection_name.c_str(),
+                _publisher.c_str(),
+                _lane.c_str());
+        } // schedule_policy_event_for_collection
     } // namespace publishing
 }; // namespace irods
 
@@ -4,11 +4,14 @@
 #define INDEXING_UTILITIES_HPP
 
 #include <list>
+#include <memory>
 #include <boost/any.hpp>
 #include <string>
+#include <vector>
 
 #include <irods/rcMisc.h>
 #include "configuration.hpp"
+#include "catalog.hpp"
 
 namespace irods {
     namespace publishing {
@@ -19,6 +22,11 @@ namespace irods {
                 ruleExecInfo_t*    _rei,
                 const std::string& _instance_name);
 
+            publisher(
+                ruleExecInfo_t*          _rei,
+                const std::string&       _instance_name,
+                std::shared_ptr<catalog> _catalog);
+
             void schedule_publishing_policy(
                 const std::string& _json,
                 const std::string& _params);
@@ -35,8 +43,18 @@ namespace irods {
                 const std::string& _value,
                 const std::string& _units );
 
+            // true when _path, or what _check covers of it, is published.
+            // throws when the catalog cannot be queried
             bool publishing_metadata_exists_in_path(
-                const std::string& _path);
+                const std::string& _path,
+                const path_check   _check = path_check::object_and_ancestors);
+
+            // the first of the objects which is published, or lies beneath a
+            // published collection, with each collection queried only once.
+            // throws when the catalog cannot be queried
+            std::string published_object_in_paths(
+                const std::vector<std::string>& _object_paths,
+                const path_check                _check = path_check::object_and_ancestors);
 
             void schedule_collection_publishing_event(
                 const std::string& _object_path,
@@ -48,10 +66,41 @@ namespace irods {
                 const std::string& _user_name,
                 const std::string& _publisher);
 
-            private:
-            using metadata_results = std::vector<std::pair<std::string, std::string>>;
+            void schedule_collection_reconcile_event(
+                const std::string& _collection_name,
+                const std::string& _publisher,
+                const std::string& _user_name);
 
-            std::string generate_delay_execution_parameters();
+            void schedule_collection_purging_event(
+                const std::string& _collection_name,
+                const std::string& _publisher,
+                const std::string& _user_name);
+
+            void schedule_object_purging_event(
+                const std::string& _object_path,
+                const std::string& _user_name,
+                const std::string& _publisher);
+
+            job_size_estimate estimate_object_size(
+                const std::string& _object_path);
+
+            job_size_estimate estimate_collection_size(
+                const std::string& _collection_name);
+
+            std::string select_lane(
+                const job_size_estimate& _estimate);
+
+            std::string generate_delay_execution_parameters(
+                const std::string& _lane);
+
+            uintmax_t sample_delay_queue_depth(
+                double& _completion_rate);
+
+            int lane_maximum_concurrency(
+                const std::string& _lane);
+
+            private:
+            using metadata_results = catalog::metadata_results;
 
             bool object_is_published(
                 const std::string& _object_path);
@@ -75,12 +124,24 @@ namespace irods {
                 const std::string& _user_name,
                 const std::string& _publisher,
                 const std::string& _publish_type,
+                const job_size_estimate& _estimate,
+                const std::string& _lane,
                 const std::string& _data_movement_params);
 
+            void schedule_policy_event_for_collection(
+                const std::string&       _event,
+                const std::string&       _collection_name,
+                const std::string&       _user_name,
+                const std::string&       _publisher,
+                const job_size_estimate& _estimate,
+                const std::string&       _lane,
+                const std::string&       _params);
+
             // Attributes
             ruleExecInfo_t* rei_;
             rsComm_t*       comm_;
             configuration   config_;
+            std::shared_ptr<catalog> catalog_;
 
             const std::string EMPTY_RESOURCE_NAME{"EMPTY_RESOURCE_NAME"};
         }; // class publisher
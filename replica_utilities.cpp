@@ -0,0 +1,142 @@
+#include "replica_utilities.hpp"
+
+#include "genquery_builder.hpp"
+
+#include <irods/irods_query.hpp>
+#include <irods/rodsConnect.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+#include <netdb.h>
+#include <unistd.h>
+
+namespace {
+    // the canonical name of _host, or _host when it cannot be resolved
+    std::string canonical_name(const std::string& _host) {
+        addrinfo hints{};
+        hints.ai_flags = AI_CANONNAME;
+        addrinfo* info{};
+        if(0 != ::getaddrinfo(_host.c_str(), nullptr, &hints, &info)) {
+            return _host;
+        }
+
+        const std::string name{info->ai_canonname ? info->ai_canonname : _host};
+        ::freeaddrinfo(info);
+        return name;
+    } // canonical_name
+
+    bool is_local_host(const std::string& _location) {
+        // the server's own resolution, which knows the aliases given in its
+        // host configuration
+        rodsHostAddr_t addr{};
+        std::strncpy(addr.hostAddr, _location.c_str(), sizeof(addr.hostAddr) - 1);
+        rodsServerHost_t* host{};
+        if(resolveHost(&addr, &host) >= 0 && host) {
+            return LOCAL_HOST == host->localFlag;
+        }
+
+        char name[256]{};
+        if(0 != ::gethostname(name, sizeof(name) - 1)) {
+            return false;
+        }
+
+        // two hosts may share a short name in different domains
+        return "localhost" == _location || canonical_name(_location) == canonical_name(name);
+    } // is_local_host
+
+    template<typename T>
+    T to_number(const std::string& _value) {
+        try {
+            return _value.empty() ? T{} : boost::lexical_cast<T>(_value);
+        }
+        catch(const boost::bad_lexical_cast&) {
+            return T{};
+        }
+    } // to_number
+} // namespace
+
+namespace irods {
+    namespace publishing {
+        std::vector<replica> list_replicas(
+            rsComm_t&          _comm,
+            const std::string& _object_path) {
+            boost::filesystem::path p{_object_path};
+            std::string query_str {
+                boost::str(boost::format(
+                "SELECT DATA_REPL_NUM, RESC_NAME, RESC_LOC, RESC_TYPE_NAME, DATA_PATH, DATA_SIZE, DATA_REPL_STATUS WHERE COLL_NAME = '%s' and DATA_NAME = '%s'")
+                % escape_genquery_literal(p.parent_path().string())
+                % escape_genquery_literal(p.filename().string())) };
+
+            std::vector<replica> replicas;
+            for(const auto& row : irods::query<rsComm_t>{&_comm, query_str}) {
+                replica r;
+                r.number     = to_number<int>(row[0]);
+                r.resource   = row[1];
+                r.location   = row[2];
+                r.type       = row[3];
+                r.vault_path = row[4];
+                r.size       = to_number<uintmax_t>(row[5]);
+                r.good       = "1" == row[6];
+                r.local      = is_local_host(r.location);
+                replicas.push_back(std::move(r));
+            }
+
+            return replicas;
+        } // list_replicas
+
+        std::vector<replica> rank_replicas(
+            std::vector<replica>       _replicas,
+            const replica_preferences& _preferences) {
+            _replicas.erase(
+                std::remove_if(_replicas.begin(), _replicas.end(),
+                               [](const replica& _r) { return !_r.good; }),
+                _replicas.end());
+
+            const auto& preferred = _preferences.preferred_resources;
+            const auto& archives  = _preferences.archive_types;
+            const auto rank = [&](const replica& _r) {
+                const auto preference = static_cast<std::size_t>(
+                    std::find(preferred.begin(), preferred.end(), _r.resource) - preferred.begin());
+                const bool archive = archives.end() != std::find(archives.begin(), archives.end(), _r.type);
+                return std::make_tuple(preference, archive, !_r.local, _r.number);
+            };
+
+            std::stable_sort(_replicas.begin(), _replicas.end(),
+                             [&](const replica& _l, const replica& _r) { return rank(_l) < rank(_r); });
+
+            return _replicas;
+        } // rank_replicas
+
+        std::optional<replica> select_replica_for_read(
+            rsComm_t&                  _comm,
+            const std::string&         _object_path,
+            const replica_preferences& _preferences) {
+            auto ranked = rank_replicas(list_replicas(_comm, _object_path), _preferences);
+            if(ranked.empty()) {
+                return std::nullopt;
+            }
+
+            return std::move(ranked.front());
+        } // select_replica_for_read
+
+        std::optional<std::string> local_vault_path(
+            const replica& _replica) {
+            if("unixfilesystem" != _replica.type || !_replica.local) {
+                return std::nullopt;
+            }
+
+            // the vault may be a mount this agent cannot see
+            if(0 != ::access(_replica.vault_path.c_str(), R_OK)) {
+                return std::nullopt;
+            }
+
+            return _replica.vault_path;
+        } // local_vault_path
+    } // namespace publishing
+} // namespace irods
@@ -0,0 +1,56 @@
+#ifndef REPLICA_UTILITIES_HPP
+#define REPLICA_UTILITIES_HPP
+
+#include <irods/rcConnect.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace irods {
+    namespace publishing {
+        struct replica {
+            int         number{};
+            std::string resource;   // the leaf resource holding the replica
+            std::string location;
+            std::string type;
+            std::string vault_path;
+            uintmax_t   size{};
+            bool        good{};
+            bool        local{};    // the leaf is served by this server
+        }; // struct replica
+
+        struct replica_preferences {
+            // read from these resources before any other, in this order
+            std::vector<std::string> preferred_resources;
+            // resource types whose replicas must be staged before they are read
+            std::vector<std::string> archive_types{"univmss", "mockarchive", "s3"};
+        }; // struct replica_preferences
+
+        // every replica of the object with its leaf resource
+        std::vector<replica> list_replicas(
+            rsComm_t&          _comm,
+            const std::string& _object_path);
+
+        // the good replicas in the order they should be read: those on the
+        // preferred resources first, then those which need no staging, then
+        // those on this server, breaking ties by replica number
+        std::vector<replica> rank_replicas(
+            std::vector<replica>       _replicas,
+            const replica_preferences& _preferences);
+
+        // the best replica to publish from, if the object has a good one
+        std::optional<replica> select_replica_for_read(
+            rsComm_t&                  _comm,
+            const std::string&         _object_path,
+            const replica_preferences& _preferences);
+
+        // the physical path of _replica when it is on a unixfilesystem
+        // resource which this server can read directly
+        std::optional<std::string> local_vault_path(
+            const replica& _replica);
+    } // namespace publishing
+} // namespace irods
+
+#endif // REPLICA_UTILITIES_HPP
@@ -0,0 +1,79 @@
+#ifndef SHARD_PLANNER_HPP
+#define SHARD_PLANNER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <vector>
+
+namespace irods {
+    namespace publishing {
+        struct shard {
+            std::vector<std::size_t> items; // indices into the sizes planned
+            uintmax_t                bytes{};
+        }; // struct shard
+
+        // pack objects of the given sizes into as few shards as the limits
+        // allow, zero leaving a limit unbounded.  objects are placed largest
+        // first into the least filled open shard, so shards come out close to
+        // even in size and publish in about the same time.  an object larger
+        // than _maximum_bytes is given a shard of its own
+        inline std::vector<shard> plan_shards(
+            const std::vector<uintmax_t>& _sizes,
+            const uintmax_t               _maximum_bytes,
+            const std::size_t             _maximum_objects) {
+            std::vector<shard> shards;
+            if(_sizes.empty()) {
+                return shards;
+            }
+
+            if(0 == _maximum_bytes && 0 == _maximum_objects) {
+                shards.resize(1);
+                shards.front().items.resize(_sizes.size());
+                std::iota(shards.front().items.begin(), shards.front().items.end(), std::size_t{0});
+                shards.front().bytes = std::accumulate(_sizes.begin(), _sizes.end(), uintmax_t{0});
+                return shards;
+            }
+
+            std::vector<std::size_t> order(_sizes.size());
+            std::iota(order.begin(), order.end(), std::size_t{0});
+            std::stable_sort(order.begin(), order.end(), [&](const std::size_t _l, const std::size_t _r) {
+                return _sizes[_l] > _sizes[_r];
+            });
+
+            // open shards by the bytes they hold, least filled on top.  a shard
+            // which reaches the object limit is not returned to the heap
+            using entry = std::pair<uintmax_t, std::size_t>;
+            std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+
+            const auto fits = [&](const shard& _s, const uintmax_t _size) {
+                return 0 == _maximum_bytes || _s.bytes + _size <= _maximum_bytes;
+            };
+
+            for(const auto i : order) {
+                std::size_t target = shards.size();
+                if(!open.empty() && fits(shards[open.top().second], _sizes[i])) {
+                    target = open.top().second;
+                    open.pop();
+                }
+                else {
+                    shards.emplace_back();
+                }
+
+                auto& s = shards[target];
+                s.items.push_back(i);
+                s.bytes += _sizes[i];
+                if(0 == _maximum_objects || s.items.size() < _maximum_objects) {
+                    open.emplace(s.bytes, target);
+                }
+            }
+
+            return shards;
+        } // plan_shards
+    } // namespace publishing
+} // namespace irods
+
+#endif // SHARD_PLANNER_HPP
@@ -0,0 +1,61 @@
+#include "shared_segment.hpp"
+
+#include <irods/rodsLog.h>
+
+#include <boost/filesystem.hpp>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace irods {
+    namespace publishing {
+        void* map_shared_segment(
+            const std::string& _name,
+            const std::size_t  _size) {
+            const auto path = boost::filesystem::temp_directory_path() / _name;
+            const int fd = ::open(path.c_str(), O_CREAT | O_RDWR, 0600);
+            if(fd < 0) {
+                rodsLog(
+                    LOG_ERROR,
+                    "map_shared_segment failed to open [%s]",
+                    path.c_str());
+                return nullptr;
+            }
+
+            // a new file is extended with zeros
+            struct stat st{};
+            if(0 != ::fstat(fd, &st) ||
+               (static_cast<std::size_t>(st.st_size) < _size &&
+                0 != ::ftruncate(fd, _size))) {
+                rodsLog(
+                    LOG_ERROR,
+                    "map_shared_segment failed to size [%s]",
+                    path.c_str());
+                ::close(fd);
+                return nullptr;
+            }
+
+            void* addr = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if(MAP_FAILED == addr) {
+                rodsLog(
+                    LOG_ERROR,
+                    "map_shared_segment failed to map [%s]",
+                    path.c_str());
+                return nullptr;
+            }
+
+            return addr;
+        } // map_shared_segment
+
+        void unmap_shared_segment(
+            void*             _segment,
+            const std::size_t _size) {
+            if(_segment) {
+                ::munmap(_segment, _size);
+            }
+        } // unmap_shared_segment
+    } // namespace publishing
+} // namespace irods
@@ -0,0 +1,23 @@
+#ifndef SHARED_SEGMENT_HPP
+#define SHARED_SEGMENT_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace irods {
+    namespace publishing {
+        // map _size bytes of the file _name beneath the temporary directory,
+        // shared by every agent on the host.  a new segment is all zeros, so
+        // structures placed in one must treat zero as their initial state.
+        // returns nullptr, having logged the reason, when the map fails
+        void* map_shared_segment(
+            const std::string& _name,
+            const std::size_t  _size);
+
+        void unmap_shared_segment(
+            void*             _segment,
+            const std::size_t _size);
+    } // namespace publishing
+} // namespace irods
+
+#endif // SHARED_SEGMENT_HPP
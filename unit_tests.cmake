@@ -0,0 +1,24 @@
+set(UNIT_TEST_TARGET_PREFIX "irods_publishing_unit_test")
+
+enable_testing()
+
+foreach(UNIT_TEST catalog genquery_builder)
+    add_executable(
+        ${UNIT_TEST_TARGET_PREFIX}-${UNIT_TEST}
+        ${CMAKE_SOURCE_DIR}/unit_tests/${UNIT_TEST}_test.cpp
+        )
+
+    target_include_directories(
+        ${UNIT_TEST_TARGET_PREFIX}-${UNIT_TEST}
+        PRIVATE
+        ${CMAKE_SOURCE_DIR}
+        ${IRODS_EXTERNALS_FULLPATH_BOOST}/include
+        )
+
+    set_property(TARGET ${UNIT_TEST_TARGET_PREFIX}-${UNIT_TEST} PROPERTY CXX_STANDARD ${IRODS_CXX_STANDARD})
+
+    add_test(
+        NAME ${UNIT_TEST}
+        COMMAND ${UNIT_TEST_TARGET_PREFIX}-${UNIT_TEST}
+        )
+endforeach()
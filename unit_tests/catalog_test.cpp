@@ -0,0 +1,164 @@
+// Exercises the catalog lookups the publisher makes on the pep hot path and
+// when it sizes a job, against memory_catalog: whether a path is published
+// for each kind of path_check, the bulk check of a bundle of objects, and the
+// size and listing of a collection.  Query counts are checked as well, since
+// fewer queries for the same answer is the point of the batched lookups.
+
+#include "memory_catalog.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+    int failures{};
+
+    void check(
+        const bool  _condition,
+        const char* _expression,
+        const int   _line) {
+        if(!_condition) {
+            std::printf("line %d: check failed: %s\n", _line, _expression);
+            ++failures;
+        }
+    } // check
+
+    #define CHECK(expression) check((expression), #expression, __LINE__)
+
+    using irods::publishing::memory_catalog;
+    using irods::publishing::path_check;
+
+    const std::string publish{"irods::publishing::publish"};
+    const std::string home{"/tempZone/home/rods"};
+
+    // home/published is annotated, home/plain holds an annotated object
+    // beside one which is not, and home/published/nested lies beneath
+    memory_catalog make_catalog() {
+        memory_catalog catalog;
+        catalog.add_collection_metadata(home + "/published", publish, "dataworld");
+        catalog.add_data_object(home + "/published/file_0", 1024);
+        catalog.add_data_object(home + "/published/nested/file_1", 2048, 2);
+        catalog.add_data_object(home + "/plain/tagged", 512);
+        catalog.add_data_object(home + "/plain/untagged", 256);
+        catalog.add_object_metadata(home + "/plain/tagged", publish, "dataworld");
+        return catalog;
+    } // make_catalog
+
+    void test_path_checks() {
+        auto catalog = make_catalog();
+        using irods::publishing::attribute_exists_in_path;
+
+        CHECK(attribute_exists_in_path(catalog, home + "/published/nested/file_1", publish));
+        CHECK(attribute_exists_in_path(catalog, home + "/published", publish));
+        CHECK(attribute_exists_in_path(catalog, home + "/plain/tagged", publish));
+        CHECK(!attribute_exists_in_path(catalog, home + "/plain/untagged", publish));
+        CHECK(!attribute_exists_in_path(catalog, home + "/plain", publish));
+
+        // a create only looks above the path, the object's own tag is not read
+        CHECK(!attribute_exists_in_path(catalog, home + "/plain/tagged", publish, path_check::parent_only));
+        CHECK(attribute_exists_in_path(catalog, home + "/published/new", publish, path_check::parent_only));
+
+        const auto before = catalog.query_count();
+        CHECK(!attribute_exists_in_path(catalog, home + "/published/file_0", publish, path_check::none));
+        CHECK(before == catalog.query_count());
+    } // test_path_checks
+
+    void test_parent_only_skips_the_object() {
+        auto catalog = make_catalog();
+        const auto path = home + "/plain/untagged";
+
+        auto before = catalog.query_count();
+        irods::publishing::attribute_exists_in_path(catalog, path, publish, path_check::object_and_ancestors);
+        const auto full = catalog.query_count() - before;
+
+        before = catalog.query_count();
+        irods::publishing::attribute_exists_in_path(catalog, path, publish, path_check::parent_only);
+        const auto parent = catalog.query_count() - before;
+
+        CHECK(parent < full);
+    } // test_parent_only_skips_the_object
+
+    void test_bulk_check() {
+        auto catalog = make_catalog();
+        using irods::publishing::object_with_attribute_in_paths;
+
+        CHECK(object_with_attribute_in_paths(catalog, {home + "/plain/untagged"}, publish).empty());
+        CHECK(home + "/plain/tagged" ==
+              object_with_attribute_in_paths(catalog, {home + "/plain/untagged", home + "/plain/tagged"}, publish));
+        CHECK(home + "/published/nested/file_1" ==
+              object_with_attribute_in_paths(catalog, {home + "/published/nested/file_1"}, publish));
+        CHECK(object_with_attribute_in_paths(catalog, {home + "/plain/tagged"}, publish, path_check::parent_only).empty());
+        CHECK(object_with_attribute_in_paths(catalog, {home + "/published/file_0"}, publish, path_check::none).empty());
+
+        // a bundle into one collection costs the same however many objects it holds
+        std::vector<std::string> small{home + "/plain/new_0"};
+        std::vector<std::string> large;
+        for(int i = 0; i < 64; ++i) {
+            large.push_back(home + "/plain/new_" + std::to_string(i));
+        }
+
+        auto before = catalog.query_count();
+        object_with_attribute_in_paths(catalog, small, publish);
+        const auto one = catalog.query_count() - before;
+
+        before = catalog.query_count();
+        object_with_attribute_in_paths(catalog, large, publish);
+        CHECK(one == catalog.query_count() - before);
+    } // test_bulk_check
+
+    void test_collection_size_and_listing() {
+        auto catalog = make_catalog();
+
+        // every replica is counted
+        const auto estimate = catalog.collection_size(home + "/published");
+        CHECK(2 * 2048 + 1024 == estimate.bytes);
+        CHECK(3 == estimate.objects);
+
+        CHECK(1 == catalog.list_data_objects(home + "/published", false).size());
+        CHECK(2 == catalog.list_data_objects(home + "/published", true).size());
+
+        // a collection whose name extends another's is not beneath it
+        catalog.add_data_object(home + "/published_other/file", 1);
+        CHECK(2 == catalog.list_data_objects(home + "/published", true).size());
+
+        CHECK(1024 == catalog.data_object_size(home + "/published/file_0"));
+        CHECK(0 == catalog.data_object_size(home + "/published/missing"));
+        CHECK(catalog.is_data_object(home + "/plain/tagged"));
+        CHECK(!catalog.is_data_object(home + "/plain"));
+    } // test_collection_size_and_listing
+
+    void test_published_paths() {
+        auto catalog = make_catalog();
+        const auto paths = catalog.paths_with_metadata(publish);
+        CHECK(2 == paths.size());
+        CHECK(1 == catalog.objects_with_metadata(home + "/plain", publish).size());
+        CHECK(catalog.objects_with_metadata(home + "/published", publish).empty());
+    } // test_published_paths
+
+    void test_delayed_rules() {
+        memory_catalog catalog;
+        catalog.add_delayed_rule("irods_policy_publishing_collection_publish");
+        catalog.add_delayed_rule("irods_policy_publishing_object_publish");
+        catalog.add_delayed_rule("irods_policy_storage_tiering");
+
+        CHECK(2 == catalog.count_delayed_rules("irods_policy_publishing"));
+        CHECK(1 == catalog.list_delayed_rules("irods_policy_publishing", 1).size());
+        CHECK(0 == catalog.count_delayed_rules("irods_policy_indexing"));
+    } // test_delayed_rules
+} // namespace
+
+int main() {
+    test_path_checks();
+    test_parent_only_skips_the_object();
+    test_bulk_check();
+    test_collection_size_and_listing();
+    test_published_paths();
+    test_delayed_rules();
+
+    if(failures > 0) {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
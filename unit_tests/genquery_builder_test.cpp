@@ -0,0 +1,72 @@
+// Checks that genquery_template places bound values into each clause as
+// written, and that a quote in a value is doubled so it cannot end the
+// literal it is placed in.
+
+#include "genquery_builder.hpp"
+
+#include <cstdio>
+#include <string>
+
+namespace {
+    int failures{};
+
+    void check(
+        const bool  _condition,
+        const char* _expression,
+        const int   _line) {
+        if(!_condition) {
+            std::printf("line %d: check failed: %s\n", _line, _expression);
+            ++failures;
+        }
+    } // check
+
+    #define CHECK(expression) check((expression), #expression, __LINE__)
+
+    using irods::publishing::genquery_template;
+
+    // stand ins for the rodsGenQuery.h column numbers
+    enum {
+        COL_COLL_NAME           = 501,
+        COL_DATA_NAME           = 403,
+        COL_META_DATA_ATTR_NAME = 600
+    };
+
+    const genquery_template subtree_query{
+        {{COL_DATA_NAME}},
+        {{COL_COLL_NAME, "= '?' || like '?/%'"}, {COL_META_DATA_ATTR_NAME, "= '?'"}}};
+
+    void test_bind() {
+        const auto r = subtree_query.bind("/tempZone/home/rods", "irods::publishing::publish");
+        CHECK(2 == r.conditions.size());
+        CHECK(COL_COLL_NAME == r.conditions[0].first);
+        CHECK("= '/tempZone/home/rods' || like '/tempZone/home/rods/%'" == r.conditions[0].second);
+        CHECK("= 'irods::publishing::publish'" == r.conditions[1].second);
+    } // test_bind
+
+    void test_bind_escapes_quotes() {
+        const auto r = subtree_query.bind("/tempZone/home/o'brien", "it's");
+        CHECK("= '/tempZone/home/o''brien' || like '/tempZone/home/o''brien/%'" == r.conditions[0].second);
+        CHECK("= 'it''s'" == r.conditions[1].second);
+
+        CHECK("a''''b" == irods::publishing::escape_genquery_literal("a''b"));
+        CHECK("plain" == irods::publishing::escape_genquery_literal("plain"));
+    } // test_bind_escapes_quotes
+
+    void test_bind_numbers() {
+        const genquery_template by_size{{{COL_DATA_NAME}}, {{COL_COLL_NAME, "> '?'"}}};
+        CHECK("> '4096'" == by_size.bind(uintmax_t{4096}).conditions[0].second);
+    } // test_bind_numbers
+} // namespace
+
+int main() {
+    test_bind();
+    test_bind_escapes_quotes();
+    test_bind_numbers();
+
+    if(failures > 0) {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    return 0;
+}